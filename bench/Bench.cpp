@@ -0,0 +1,347 @@
+#include "../src/coroutine/Awaiter.hpp"
+#include "../src/log/Exception.hpp"
+#include "../src/metric/Histogram.hpp"
+#include "../src/ring/Ring.hpp"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <format>
+#include <print>
+#include <ranges>
+#include <thread>
+#include <unistd.h>
+
+struct Options {
+    std::string host{"127.0.0.1"};
+    unsigned short port{8080};
+    unsigned int threadCount{std::max(std::thread::hardware_concurrency() / 2, 1U)}, connectionCount{64}, depth{1},
+        heavyCount{};
+    std::chrono::seconds duration{10}, timeout{5};
+    std::vector<std::string> requests;
+    std::string heavyRequest;
+};
+
+struct Statistics {
+    // the light histogram leaves out the heavy connections, it is their neighbours whose tail a skewed load hurts
+    Histogram histogram, lightHistogram;
+    unsigned long responseCount, byteCount, errorCount, timeoutCount;
+};
+
+template<typename T>
+[[nodiscard]] constexpr auto toNumber(const std::string_view name, const std::string_view value,
+                                      const std::source_location sourceLocation = std::source_location::current())
+    -> T {
+    T number;
+    if (const auto [point, error]{std::from_chars(value.cbegin(), value.cend(), number)};
+        error != std::errc{} || point != value.cend()) {
+        throw Exception{
+            Log{Log::Level::fatal, std::format("invalid value of {}: {}", name, value), sourceLocation}
+        };
+    }
+
+    return number;
+}
+
+[[nodiscard]] auto createRequest(const std::string_view kind, const std::source_location sourceLocation =
+                                                                  std::source_location::current()) -> std::string {
+    if (kind == "html") return "GET /index.html HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: br\r\n\r\n";
+    if (kind == "png") return "GET /background.png HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    if (kind == "range") return "GET /video.mp4 HTTP/1.1\r\nHost: localhost\r\nRange: bytes=0-65535\r\n\r\n";
+    if (kind == "login") {
+        constexpr std::string_view body{R"({"method":"login","id":"1","password":"1"})"};
+
+        return std::format("POST / HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\n"
+                           "Content-Length: {}\r\n\r\n{}",
+                           body.size(), body);
+    }
+
+    throw Exception{
+        Log{Log::Level::fatal, std::format("unknown request kind: {}", kind), sourceLocation}
+    };
+}
+
+[[nodiscard]] auto parse(const std::span<const char *const> arguments,
+                         const std::source_location sourceLocation = std::source_location::current()) -> Options {
+    Options options;
+    std::string_view mix{"html:1"};
+
+    for (const std::string_view argument : arguments) {
+        const unsigned long splitPoint{argument.find('=')};
+        const std::string_view name{argument.substr(0, splitPoint)},
+            value{splitPoint == std::string_view::npos ? std::string_view{} : argument.substr(splitPoint + 1)};
+
+        if (name == "--host") options.host = value;
+        else if (name == "--port") options.port = toNumber<unsigned short>(name, value);
+        else if (name == "--threads") options.threadCount = toNumber<unsigned int>(name, value);
+        else if (name == "--connections") options.connectionCount = toNumber<unsigned int>(name, value);
+        else if (name == "--depth") options.depth = toNumber<unsigned int>(name, value);
+        else if (name == "--duration") options.duration = std::chrono::seconds{toNumber<unsigned long>(name, value)};
+        else if (name == "--timeout") options.timeout = std::chrono::seconds{toNumber<unsigned long>(name, value)};
+        else if (name == "--mix") mix = value;
+        else if (name == "--heavy") {
+            const unsigned long kindPoint{value.find(':')};
+            options.heavyCount = toNumber<unsigned int>(name, value.substr(0, kindPoint));
+            options.heavyRequest =
+                createRequest(kindPoint == std::string_view::npos ? "range" : value.substr(kindPoint + 1));
+        } else {
+            throw Exception{
+                Log{Log::Level::fatal, std::format("unknown option: {}", argument), sourceLocation}
+            };
+        }
+    }
+
+    // a weighted mix is expanded into a fixed sequence, so every run sends the same requests in the same order
+    for (const auto part : mix | std::views::split(',')) {
+        const std::string_view entry{part.begin(), part.end()};
+        const unsigned long splitPoint{entry.find(':')};
+        const unsigned int weight{
+            splitPoint == std::string_view::npos ? 1 : toNumber<unsigned int>("--mix", entry.substr(splitPoint + 1))};
+
+        const std::string request{createRequest(entry.substr(0, splitPoint))};
+        for (unsigned int i{}; i != weight; ++i) options.requests.emplace_back(request);
+    }
+
+    if (options.threadCount == 0 || options.connectionCount < options.threadCount || options.depth == 0 ||
+        options.requests.empty()) {
+        throw Exception{
+            Log{Log::Level::fatal, "every thread needs a connection and a request to send", sourceLocation}
+        };
+    }
+    // the server answers the first request of a receive only, the rest of a pipelined batch would never be answered
+    if (options.depth != 1) {
+        throw Exception{
+            Log{Log::Level::fatal, "the server does not split pipelined requests yet, --depth has to be 1",
+                sourceLocation}
+        };
+    }
+    if (options.timeout.count() == 0) {
+        throw Exception{
+            Log{Log::Level::fatal, "a round needs time to be answered", sourceLocation}
+        };
+    }
+    if (options.heavyCount >= options.connectionCount) {
+        throw Exception{
+            Log{Log::Level::fatal, "a skewed load needs light connections next to the heavy ones", sourceLocation}
+        };
+    }
+
+    return options;
+}
+
+[[nodiscard]] auto connect(const Options &options,
+                           const std::source_location sourceLocation = std::source_location::current()) -> int {
+    const int fileDescriptor{::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+
+    if (fileDescriptor == -1 || inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1 ||
+        ::connect(fileDescriptor, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == -1) {
+        throw Exception{
+            Log{Log::Level::fatal, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
+        };
+    }
+
+    return fileDescriptor;
+}
+
+// removes the complete responses at the front of the data and returns how many there were
+[[nodiscard]] auto consume(std::string &data, const std::chrono::steady_clock::time_point start, const bool isHeavy,
+                           Statistics &statistics) -> unsigned int {
+    unsigned int count{};
+    for (unsigned long headerEnd{data.find("\r\n\r\n")}; headerEnd != std::string::npos;
+         headerEnd = data.find("\r\n\r\n")) {
+        const std::string_view header{data.data(), headerEnd};
+
+        unsigned long bodySize{};
+        if (const unsigned long position{header.find("Content-Length: ")}; position != std::string_view::npos) {
+            const std::string_view value{header.substr(position + 16)};
+            std::from_chars(value.cbegin(), value.cend(), bodySize);
+        }
+
+        const unsigned long size{headerEnd + 4 + bodySize};
+        if (data.size() < size) break;
+
+        const auto latency{std::chrono::nanoseconds{std::chrono::steady_clock::now() - start}.count()};
+        statistics.histogram.record(latency);
+        if (!isHeavy) statistics.lightHistogram.record(latency);
+        ++statistics.responseCount;
+        statistics.byteCount += size;
+        if (!header.starts_with("HTTP/1.1 2")) ++statistics.errorCount;
+
+        data.erase(0, size);
+        ++count;
+    }
+
+    return count;
+}
+
+// a closed loop per connection: a batch of pipelined requests goes out once all responses to the last one arrived
+[[nodiscard]] auto request(const int fileDescriptor, const Options &options, unsigned long next, const bool isHeavy,
+                           std::chrono::steady_clock::time_point &deadline, Statistics &statistics,
+                           unsigned long &activeCount) -> Task {
+    std::string batch, received;
+    std::vector<std::byte> buffer(64 * 1024);
+
+    while (true) {
+        batch.clear();
+        for (unsigned int i{}; i != options.depth; ++i)
+            batch += isHeavy ? options.heavyRequest : options.requests[next++ % options.requests.size()];
+
+        const auto start{std::chrono::steady_clock::now()};
+        deadline = start + options.timeout;
+        if (const auto [result, flags]{co_await Awaiter{
+                Submission{fileDescriptor, 0, 0, 0, Submission::Send{std::as_bytes(std::span{batch}), 0, 0, false}}
+            }};
+            result != static_cast<int>(batch.size())) {
+            ++statistics.errorCount;
+            --activeCount;
+
+            co_return;
+        }
+
+        for (unsigned int responseCount{}; responseCount < options.depth;) {
+            const auto [result, flags]{
+                co_await Awaiter{Submission{fileDescriptor, 0, 0, 0, Submission::Read{buffer, 0}}}
+            };
+            if (result <= 0) {
+                if (result < 0) ++statistics.errorCount;
+                --activeCount;
+
+                co_return;
+            }
+
+            received.append(reinterpret_cast<const char *>(buffer.data()), result);
+            responseCount += consume(received, start, isHeavy, statistics);
+        }
+        deadline = std::chrono::steady_clock::time_point::max();
+    }
+}
+
+// a round without its answers in time is cut by shutting its connection down, the pending read then ends with 0
+[[nodiscard]] auto watch(const std::span<const int> fileDescriptors,
+                         const std::span<std::chrono::steady_clock::time_point> deadlines, Statistics &statistics)
+    -> Task {
+    __kernel_timespec interval{.tv_sec = 1, .tv_nsec = 0};
+
+    while (true) {
+        co_await Awaiter{
+            Submission{-1, 0, 0, 0, Submission::Timeout{&interval, 0}}
+        };
+
+        const auto now{std::chrono::steady_clock::now()};
+        for (unsigned long i{}; i != fileDescriptors.size(); ++i) {
+            if (now > deadlines[i]) {
+                ++statistics.timeoutCount;
+                deadlines[i] = std::chrono::steady_clock::time_point::max();
+                shutdown(fileDescriptors[i], SHUT_RDWR);
+            }
+        }
+    }
+}
+
+auto run(const Options &options, const std::span<const int> fileDescriptors, const unsigned long firstIndex,
+         const std::atomic_flag &switcher, Statistics &statistics) -> void {
+    // declared first so that the ring, with requests still in flight, goes before the frames they point to
+    std::vector<Task> tasks;
+    std::vector deadlines(fileDescriptors.size(), std::chrono::steady_clock::time_point::max());
+    unsigned long activeCount{fileDescriptors.size()};
+
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CLAMP | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER |
+                   IORING_SETUP_COOP_TASKRUN | IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_CQSIZE;
+    params.cq_entries = std::bit_ceil(fileDescriptors.size()) * 4;
+    Ring ring{std::bit_ceil(static_cast<unsigned int>(fileDescriptors.size())), params};
+
+    // connections start at different points of the mix, and the first ones opened are the heavy ones
+    for (unsigned long i{}; i != fileDescriptors.size(); ++i) {
+        const Task &task{tasks.emplace_back(request(fileDescriptors[i], options, fileDescriptors[i],
+                                                    firstIndex + i < options.heavyCount, deadlines[i], statistics,
+                                                    activeCount))};
+        task.resume(Outcome{});
+        ring.submit(task.takeSubmission());
+    }
+
+    const Task &watcher{tasks.emplace_back(watch(fileDescriptors, deadlines, statistics))};
+    watcher.resume(Outcome{});
+    ring.submit(watcher.takeSubmission());
+
+    while (switcher.test(std::memory_order::relaxed) && activeCount != 0) {
+        ring.wait(1);
+
+        const int completionCount{ring.poll([&ring](const Completion &completion) {
+            if (completion.outcome.result == 0 && (completion.outcome.flags & IORING_CQE_F_NOTIF) != 0) return;
+
+            Task::promise_type &promise{Task::getPromise(completion.userData)};
+            promise.resume(completion.outcome);
+
+            if (promise.isSubmissionPending()) ring.submit(promise.takeSubmission());
+        })};
+        ring.advance(completionCount);
+    }
+}
+
+auto main(const int argc, const char *const *const argv) -> int {
+    const Options options{parse(std::span{argv + 1, static_cast<unsigned long>(argc - 1)})};
+
+    std::vector<int> fileDescriptors;
+    for (unsigned int i{}; i != options.connectionCount; ++i) fileDescriptors.emplace_back(connect(options));
+
+    std::atomic_flag switcher{true};
+    std::vector<Statistics> statistics(options.threadCount);
+    const auto start{std::chrono::steady_clock::now()};
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned int i{}; i != options.threadCount; ++i) {
+            const unsigned long begin{fileDescriptors.size() * i / options.threadCount},
+                end{fileDescriptors.size() * (i + 1) / options.threadCount};
+
+            threads.emplace_back(run, std::cref(options), std::span{fileDescriptors}.subspan(begin, end - begin),
+                                 begin, std::cref(switcher), std::ref(statistics[i]));
+        }
+
+        std::this_thread::sleep_for(options.duration);
+        switcher.clear(std::memory_order::relaxed);
+
+        // pending reads complete with 0 once the sockets are shut down, which wakes every thread up to stop
+        for (const int fileDescriptor : fileDescriptors) shutdown(fileDescriptor, SHUT_RDWR);
+    }
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+    for (const int fileDescriptor : fileDescriptors) close(fileDescriptor);
+
+    Statistics total{};
+    for (const Statistics &element : statistics) {
+        total.histogram.merge(element.histogram);
+        total.lightHistogram.merge(element.lightHistogram);
+        total.responseCount += element.responseCount;
+        total.byteCount += element.byteCount;
+        total.errorCount += element.errorCount;
+        total.timeoutCount += element.timeoutCount;
+    }
+
+    const Histogram &histogram{total.histogram};
+    std::println("{} threads, {} connections, pipelining depth {}, {:.2f}s", options.threadCount,
+                 options.connectionCount, options.depth, elapsed.count());
+    std::println("responses: {}, errors: {}, timeouts: {}", total.responseCount, total.errorCount,
+                 total.timeoutCount);
+    std::println("throughput: {:.0f} requests/s, {:.2f} MiB/s", total.responseCount / elapsed.count(),
+                 total.byteCount / elapsed.count() / (1024 * 1024));
+    std::println("latency (us): mean {:.1f}, p50 {:.1f}, p90 {:.1f}, p99 {:.1f}, p99.9 {:.1f}, max {:.1f}",
+                 histogram.getMean() / 1000, histogram.getPercentile(50) / 1000.0,
+                 histogram.getPercentile(90) / 1000.0, histogram.getPercentile(99) / 1000.0,
+                 histogram.getPercentile(99.9) / 1000.0, histogram.getMax() / 1000.0);
+    if (options.heavyCount != 0) {
+        const Histogram &lightHistogram{total.lightHistogram};
+        std::println("light connections latency (us) next to {} heavy ones: p50 {:.1f}, p99 {:.1f}, p99.9 {:.1f}, "
+                     "max {:.1f}",
+                     options.heavyCount, lightHistogram.getPercentile(50) / 1000.0,
+                     lightHistogram.getPercentile(99) / 1000.0, lightHistogram.getPercentile(99.9) / 1000.0,
+                     lightHistogram.getMax() / 1000.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include "../src/coroutine/Awaiter.hpp"
+#include "../src/fileDescriptor/Timer.hpp"
+#include "../src/http/HttpRequest.hpp"
+#include "../src/http/HttpResponse.hpp"
+#include "../src/json/JsonValue.hpp"
+#include "../src/log/Log.hpp"
+#include "../src/ring/Ring.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <print>
+
+// keeps the compiler from dropping a result nobody reads
+template<typename T>
+auto keep(const T &value) noexcept -> void {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// every benchmark is repeated and reported as one json line, so runs can be diffed between commits
+template<typename Prepare, typename Run>
+auto measure(const std::string_view name, const unsigned long operationCount, Prepare &&prepare, Run &&run) -> void {
+    constexpr unsigned int repetitionCount{5};
+
+    std::array<double, repetitionCount> results;
+    for (double &result : results) {
+        prepare();
+
+        const auto start{std::chrono::steady_clock::now()};
+        run();
+        const std::chrono::duration<double, std::nano> elapsed{std::chrono::steady_clock::now() - start};
+
+        result = elapsed.count() / static_cast<double>(operationCount);
+    }
+    std::ranges::sort(results);
+
+    std::println(R"({{"name":"{}","operations":{},"repetitions":{},"minimumNs":{:.2f},"medianNs":{:.2f}}})", name,
+                 operationCount, repetitionCount, results.front(), results[repetitionCount / 2]);
+}
+
+template<typename Run>
+auto measure(const std::string_view name, const unsigned long operationCount, Run &&run) -> void {
+    measure(name, operationCount, [] {}, std::forward<Run>(run));
+}
+
+// the same completion path as Scheduler::frame, driven by nop requests so only userspace cost is measured
+[[nodiscard]] auto nop() -> Task {
+    while (true) co_await Awaiter{Submission{-1, 0, 0, 0, Submission::Nop{}}};
+}
+
+auto benchmarkRing() -> void {
+    constexpr unsigned int entries{256};
+    constexpr unsigned long completionCount{1'000'000};
+
+    // declared first so that the ring, with requests still in flight, goes before the frames they point to
+    std::vector<Task> tasks;
+
+    io_uring_params params{};
+    params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    Ring ring{entries, params};
+
+    for (unsigned int i{}; i != entries; ++i) {
+        const Task &task{tasks.emplace_back(nop())};
+        task.resume(Outcome{});
+        ring.submit(task.takeSubmission());
+    }
+
+    measure("ring.nopCompletion", completionCount, [&ring] {
+        for (unsigned long count{}; count < completionCount;) {
+            ring.wait(1);
+
+            const int batch{ring.poll([&ring](const Completion &completion) {
+                Task::promise_type &promise{Task::getPromise(completion.userData)};
+                promise.resume(completion.outcome);
+
+                if (promise.isSubmissionPending()) ring.submit(promise.takeSubmission());
+            })};
+            ring.advance(batch);
+
+            count += batch;
+        }
+    });
+}
+
+auto benchmarkHttpRequest() -> void {
+    constexpr unsigned long roundCount{100'000};
+    constexpr std::array<std::string_view, 4> corpus{
+        "GET /index.html HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: gzip, deflate, br\r\n\r\n",
+        "GET /background.png HTTP/1.1\r\nHost: localhost\r\nUser-Agent: webServerBench\r\nAccept: */*\r\n"
+        "Connection: keep-alive\r\n\r\n",
+        "GET /video.mp4 HTTP/1.1\r\nHost: localhost\r\nRange: bytes=0-65535\r\nAccept: */*\r\n\r\n",
+        "POST / HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\nContent-Length: 42\r\n\r\n"
+        R"({"method":"login","id":"1","password":"1"})",
+    };
+
+    measure("httpRequest.parse", roundCount * corpus.size(), [&corpus] {
+        for (unsigned long i{}; i != roundCount; ++i) {
+            for (const std::string_view request : corpus) {
+                const HttpRequest httpRequest{request};
+                keep(httpRequest.getUrl());
+            }
+        }
+    });
+}
+
+auto benchmarkJson() -> void {
+    constexpr unsigned long count{100'000};
+    constexpr std::string_view json{
+        R"({"method":"login","id":"1","password":"1","profile":{"name":"webServer","age":30,"score":1.5,)"
+        R"("active":true,"extra":null,"tags":["io_uring","coroutine","http"]}})"};
+
+    measure("json.parse", count, [json] {
+        for (unsigned long i{}; i != count; ++i) {
+            const JsonObject jsonObject{json};
+            keep(jsonObject);
+        }
+    });
+
+    const JsonObject jsonObject{json};
+    measure("json.serialize", count, [&jsonObject] {
+        for (unsigned long i{}; i != count; ++i) keep(jsonObject.toString());
+    });
+}
+
+auto benchmarkTimer() -> void {
+    constexpr int connectionCount{100'000};
+
+    std::optional<Timer> timer;
+    const auto fill{[&timer] {
+        timer.emplace(-1);
+        for (int i{}; i != connectionCount; ++i) timer->add(i, std::chrono::seconds{i % 60 + 1});
+    }};
+
+    measure("timer.add", connectionCount, [&timer] { timer.emplace(-1); }, [&timer] {
+        for (int i{}; i != connectionCount; ++i) timer->add(i, std::chrono::seconds{i % 60 + 1});
+    });
+
+    measure("timer.update", connectionCount, fill, [&timer] {
+        for (int i{}; i != connectionCount; ++i) timer->update(i, std::chrono::seconds{60});
+    });
+
+    // two turns of the wheel expire every connection, whatever its timeout
+    measure("timer.expire", connectionCount, fill, [&timer] { keep(timer->expire(122)); });
+}
+
+auto benchmarkHttpResponse() -> void {
+    constexpr unsigned long smallCount{100'000}, largeCount{100};
+
+    const auto create{[](const unsigned long bodySize) {
+        HttpResponse httpResponse;
+        httpResponse.setVersion("HTTP/1.1");
+        httpResponse.setStatusCode("200 OK");
+        httpResponse.addHeader("Content-Type: text/html; charset=utf-8");
+        httpResponse.addHeader("Content-Length: " + std::to_string(bodySize));
+        httpResponse.setBody(std::vector(bodySize, std::byte{'a'}));
+
+        return httpResponse;
+    }};
+
+    const HttpResponse small{create(128)}, large{create(1024 * 1024)};
+    measure("httpResponse.toByte.128B", smallCount, [&small] {
+        for (unsigned long i{}; i != smallCount; ++i) keep(small.toByte());
+    });
+    measure("httpResponse.toByte.1MiB", largeCount, [&large] {
+        for (unsigned long i{}; i != largeCount; ++i) keep(large.toByte());
+    });
+}
+
+auto benchmarkLog() -> void {
+    constexpr unsigned long count{100'000};
+
+    const Log log{Log::Level::warn, "connection closed"};
+    measure("log.toString", count, [&log] {
+        for (unsigned long i{}; i != count; ++i) keep(log.toString());
+    });
+}
+
+auto main() -> int {
+    benchmarkRing();
+    benchmarkHttpRequest();
+    benchmarkJson();
+    benchmarkTimer();
+    benchmarkHttpResponse();
+    benchmarkLog();
+
+    return 0;
+}
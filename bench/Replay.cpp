@@ -0,0 +1,306 @@
+#include "../src/coroutine/Awaiter.hpp"
+#include "../src/fileDescriptor/Recorder.hpp"
+#include "../src/log/Exception.hpp"
+#include "../src/metric/Histogram.hpp"
+#include "../src/ring/Ring.hpp"
+
+#include <arpa/inet.h>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <print>
+#include <ranges>
+#include <unistd.h>
+
+struct Options {
+    std::string host{"127.0.0.1"};
+    unsigned short port{8080};
+    bool isPaced{true};
+    std::vector<std::string> files;
+};
+
+struct Request {
+    std::chrono::nanoseconds time;
+    std::span<const std::byte> data;
+};
+
+struct Connection {
+    int fileDescriptor;
+    std::vector<Request> requests;
+    std::deque<std::chrono::steady_clock::time_point> sentTimes;
+    bool isSent;
+};
+
+struct Statistics {
+    Histogram histogram;
+    unsigned long requestCount, responseCount, byteCount, errorCount, activeCount;
+};
+
+template<typename T>
+[[nodiscard]] constexpr auto toNumber(const std::string_view name, const std::string_view value,
+                                      const std::source_location sourceLocation = std::source_location::current())
+    -> T {
+    T number;
+    if (const auto [point, error]{std::from_chars(value.cbegin(), value.cend(), number)};
+        error != std::errc{} || point != value.cend()) {
+        throw Exception{
+            Log{Log::Level::fatal, std::format("invalid value of {}: {}", name, value), sourceLocation}
+        };
+    }
+
+    return number;
+}
+
+[[nodiscard]] auto parse(const std::span<const char *const> arguments,
+                         const std::source_location sourceLocation = std::source_location::current()) -> Options {
+    Options options;
+
+    for (const std::string_view argument : arguments) {
+        const unsigned long splitPoint{argument.find('=')};
+        const std::string_view name{argument.substr(0, splitPoint)},
+            value{splitPoint == std::string_view::npos ? std::string_view{} : argument.substr(splitPoint + 1)};
+
+        if (!argument.starts_with("--")) options.files.emplace_back(argument);
+        else if (name == "--host") options.host = value;
+        else if (name == "--port") options.port = toNumber<unsigned short>(name, value);
+        else if (name == "--speed" && (value == "1x" || value == "max")) options.isPaced = value == "1x";
+        else {
+            throw Exception{
+                Log{Log::Level::fatal, std::format("unknown option: {}", argument), sourceLocation}
+            };
+        }
+    }
+
+    if (options.files.empty()) {
+        throw Exception{
+            Log{Log::Level::fatal, "no capture file to replay", sourceLocation}
+        };
+    }
+
+    return options;
+}
+
+[[nodiscard]] auto read(const std::string &file, const std::source_location sourceLocation =
+                                                      std::source_location::current()) -> std::vector<std::byte> {
+    std::ifstream stream{file, std::ios::binary};
+    std::vector<std::byte> data(stream ? std::filesystem::file_size(file) : 0);
+    if (!stream || !stream.read(reinterpret_cast<char *>(data.data()), static_cast<long>(data.size())) ||
+        !std::string_view{reinterpret_cast<const char *>(data.data()), data.size()}.starts_with(
+            Recorder::signature)) {
+        throw Exception{
+            Log{Log::Level::fatal, "not a capture file: " + file, sourceLocation}
+        };
+    }
+
+    return data;
+}
+
+// splits a capture into its connections, a record cut short by a stopped server ends the capture
+auto load(const std::span<const std::byte> capture, const unsigned long captureIndex,
+          std::map<unsigned long, Connection> &connections) -> void {
+    for (unsigned long offset{Recorder::signature.size()}; offset + sizeof(Recorder::Record) <= capture.size();) {
+        Recorder::Record record;
+        std::memcpy(&record, capture.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if (offset + record.size > capture.size()) break;
+
+        // connection numbers are only unique within the capture of one scheduler
+        connections[captureIndex << 32 | record.connection].requests.emplace_back(
+            std::chrono::nanoseconds{record.time}, capture.subspan(offset, record.size));
+        offset += record.size;
+    }
+}
+
+[[nodiscard]] auto connect(const Options &options,
+                           const std::source_location sourceLocation = std::source_location::current()) -> int {
+    const int fileDescriptor{::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+
+    if (fileDescriptor == -1 || inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1 ||
+        ::connect(fileDescriptor, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == -1) {
+        throw Exception{
+            Log{Log::Level::fatal, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
+        };
+    }
+
+    return fileDescriptor;
+}
+
+// a record is a receive, which holds part of a request, a whole one or several pipelined ones
+[[nodiscard]] auto countRequests(const std::span<const std::byte> data) -> unsigned int {
+    const std::string_view text{reinterpret_cast<const char *>(data.data()), data.size()};
+
+    unsigned int count{};
+    for (unsigned long position{text.find(" HTTP/1.1\r\n")}; position != std::string_view::npos;
+         position = text.find(" HTTP/1.1\r\n", position + 1))
+        ++count;
+
+    return count;
+}
+
+// removes the complete responses at the front of the data, each answers the oldest request still waiting
+auto consume(std::string &data, Connection &connection, Statistics &statistics) -> void {
+    for (unsigned long headerEnd{data.find("\r\n\r\n")}; headerEnd != std::string::npos;
+         headerEnd = data.find("\r\n\r\n")) {
+        const std::string_view header{data.data(), headerEnd};
+
+        unsigned long bodySize{};
+        if (const unsigned long position{header.find("Content-Length: ")}; position != std::string_view::npos) {
+            const std::string_view value{header.substr(position + 16)};
+            std::from_chars(value.cbegin(), value.cend(), bodySize);
+        }
+
+        const unsigned long size{headerEnd + 4 + bodySize};
+        if (data.size() < size) break;
+
+        if (!connection.sentTimes.empty()) {
+            statistics.histogram.record(
+                std::chrono::nanoseconds{std::chrono::steady_clock::now() - connection.sentTimes.front()}.count());
+            connection.sentTimes.pop_front();
+        }
+        ++statistics.responseCount;
+        statistics.byteCount += size;
+        if (!header.starts_with("HTTP/1.1 2")) ++statistics.errorCount;
+
+        data.erase(0, size);
+    }
+}
+
+[[nodiscard]] auto send(Connection &connection, const bool isPaced, const std::chrono::steady_clock::time_point start,
+                        const std::chrono::nanoseconds base, Statistics &statistics) -> Task {
+    bool isFailed{};
+    for (const auto &[time, data] : connection.requests) {
+        if (isPaced) {
+            // offsets from the first captured request become absolute deadlines on the clock the timeout uses
+            const std::chrono::nanoseconds deadline{(start + (time - base)).time_since_epoch()};
+            __kernel_timespec timespec{std::chrono::duration_cast<std::chrono::seconds>(deadline).count(),
+                                       deadline.count() % 1'000'000'000};
+            co_await Awaiter{
+                Submission{-1, 0, 0, 0, Submission::Timeout{&timespec, IORING_TIMEOUT_ABS}}
+            };
+        }
+
+        const unsigned int requestCount{countRequests(data)};
+        connection.sentTimes.insert(connection.sentTimes.cend(), requestCount, std::chrono::steady_clock::now());
+        statistics.requestCount += requestCount;
+
+        if (const auto [result, flags]{co_await Awaiter{
+                Submission{connection.fileDescriptor, 0, 0, 0, Submission::Send{data, MSG_NOSIGNAL, 0, false}}
+            }};
+            result != static_cast<int>(data.size())) {
+            ++statistics.errorCount;
+            isFailed = true;
+
+            break;
+        }
+    }
+
+    connection.isSent = true;
+
+    // the pending read completes with 0 once the socket is shut down, which ends the receiving task
+    if (isFailed || connection.sentTimes.empty()) shutdown(connection.fileDescriptor, SHUT_RDWR);
+}
+
+[[nodiscard]] auto receive(Connection &connection, Statistics &statistics) -> Task {
+    std::string received;
+    std::vector<std::byte> buffer(64 * 1024);
+
+    while (true) {
+        const auto [result, flags]{
+            co_await Awaiter{Submission{connection.fileDescriptor, 0, 0, 0, Submission::Read{buffer, 0}}}
+        };
+        if (result <= 0) {
+            if (result < 0) ++statistics.errorCount;
+
+            break;
+        }
+
+        received.append(reinterpret_cast<const char *>(buffer.data()), result);
+        consume(received, connection, statistics);
+
+        if (connection.isSent && connection.sentTimes.empty()) shutdown(connection.fileDescriptor, SHUT_RDWR);
+    }
+
+    --statistics.activeCount;
+}
+
+auto main(const int argc, const char *const *const argv) -> int {
+    const Options options{parse(std::span{argv + 1, static_cast<unsigned long>(argc - 1)})};
+
+    std::vector<std::vector<std::byte>> captures;
+    for (const std::string &file : options.files) captures.emplace_back(read(file));
+
+    std::map<unsigned long, Connection> connections;
+    for (unsigned long i{}; i != captures.size(); ++i) load(captures[i], i, connections);
+
+    std::chrono::nanoseconds base{std::chrono::nanoseconds::max()};
+    for (const Connection &connection : connections | std::views::values) {
+        if (!connection.requests.empty()) base = std::min(base, connection.requests.front().time);
+    }
+
+    Statistics statistics{};
+    statistics.activeCount = connections.size();
+    for (Connection &connection : connections | std::views::values) connection.fileDescriptor = connect(options);
+
+    const auto start{std::chrono::steady_clock::now()};
+    {
+        // declared first so that the ring, with requests still in flight, goes before the frames they point to
+        std::vector<Task> tasks;
+
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CLAMP | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER |
+                       IORING_SETUP_COOP_TASKRUN | IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_CQSIZE;
+        const unsigned int entries{std::bit_ceil(static_cast<unsigned int>(connections.size()) * 2)};
+        params.cq_entries = entries * 4;
+        Ring ring{entries, params};
+
+        const auto launch{[&tasks, &ring](Task &&task) {
+            const Task &element{tasks.emplace_back(std::move(task))};
+            element.resume(Outcome{});
+            ring.submit(element.takeSubmission());
+        }};
+        for (Connection &connection : connections | std::views::values) {
+            launch(receive(connection, statistics));
+            launch(send(connection, options.isPaced, start, base, statistics));
+        }
+
+        while (statistics.activeCount != 0) {
+            ring.wait(1);
+
+            const int completionCount{ring.poll([&ring](const Completion &completion) {
+                if (completion.outcome.result == 0 && (completion.outcome.flags & IORING_CQE_F_NOTIF) != 0) return;
+
+                Task::promise_type &promise{Task::getPromise(completion.userData)};
+                promise.resume(completion.outcome);
+
+                if (promise.isSubmissionPending()) ring.submit(promise.takeSubmission());
+            })};
+            ring.advance(completionCount);
+        }
+    }
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+    for (const Connection &connection : connections | std::views::values) close(connection.fileDescriptor);
+
+    const Histogram &histogram{statistics.histogram};
+    std::println("{} captures, {} connections, {} speed, {:.2f}s", captures.size(), connections.size(),
+                 options.isPaced ? "1x" : "max", elapsed.count());
+    std::println("requests: {}, responses: {}, errors: {}", statistics.requestCount, statistics.responseCount,
+                 statistics.errorCount);
+    std::println("throughput: {:.0f} requests/s, {:.2f} MiB/s", statistics.responseCount / elapsed.count(),
+                 statistics.byteCount / elapsed.count() / (1024 * 1024));
+    std::println("latency (us): mean {:.1f}, p50 {:.1f}, p90 {:.1f}, p99 {:.1f}, p99.9 {:.1f}, max {:.1f}",
+                 histogram.getMean() / 1000, histogram.getPercentile(50) / 1000.0,
+                 histogram.getPercentile(90) / 1000.0, histogram.getPercentile(99) / 1000.0,
+                 histogram.getPercentile(99.9) / 1000.0, histogram.getMax() / 1000.0);
+
+    return 0;
+}
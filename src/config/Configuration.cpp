@@ -0,0 +1,101 @@
+#include "Configuration.hpp"
+
+#include "../log/Exception.hpp"
+
+#include <charconv>
+#include <linux/ioprio.h>
+
+template<typename T>
+[[nodiscard]] static constexpr auto toNumber(const std::string_view name, const std::string_view value,
+                                             const std::source_location sourceLocation) -> T {
+    T number;
+    if (const auto [point, error]{std::from_chars(value.cbegin(), value.cend(), number)};
+        error != std::errc{} || point != value.cend()) {
+        throw Exception{
+            Log{Log::Level::fatal, std::format("invalid value of {}: {}", name, value), sourceLocation}
+        };
+    }
+
+    return number;
+}
+
+[[nodiscard]] static constexpr auto toPriority(const std::string_view name, const std::string_view value,
+                                               const std::source_location sourceLocation) -> unsigned short {
+    const unsigned long splitPoint{value.find(':')};
+    const std::string_view priorityClass{value.substr(0, splitPoint)};
+    const unsigned short level{splitPoint == std::string_view::npos ?
+                                   static_cast<unsigned short>(0) :
+                                   toNumber<unsigned short>(name, value.substr(splitPoint + 1), sourceLocation)};
+    if (level >= IOPRIO_NR_LEVELS) {
+        throw Exception{
+            Log{Log::Level::fatal, std::format("invalid value of {}: {}", name, value), sourceLocation}
+        };
+    }
+
+    if (priorityClass == "rt") return IOPRIO_PRIO_VALUE(IOPRIO_CLASS_RT, level);
+    if (priorityClass == "be") return IOPRIO_PRIO_VALUE(IOPRIO_CLASS_BE, level);
+    if (priorityClass == "idle") return IOPRIO_PRIO_VALUE(IOPRIO_CLASS_IDLE, level);
+
+    throw Exception{
+        Log{Log::Level::fatal, std::format("invalid value of {}: {}", name, value), sourceLocation}
+    };
+}
+
+auto Configuration::parse(const std::span<const char *const> arguments, const std::source_location sourceLocation)
+    -> Configuration {
+    Configuration configuration{};
+
+    for (const std::string_view argument : arguments) {
+        const unsigned long splitPoint{argument.find('=')};
+        const std::string_view name{argument.substr(0, splitPoint)},
+            value{splitPoint == std::string_view::npos ? std::string_view{} : argument.substr(splitPoint + 1)};
+
+        if (name == "--sqpoll") configuration.isSubmissionQueuePolling = true;
+        else if (name == "--sqpoll-shared") configuration.isSubmissionQueueShared = true;
+        else if (name == "--sqpoll-cpu") configuration.submissionQueueCpu = toNumber<int>(name, value, sourceLocation);
+        else if (name == "--sqpoll-idle") {
+            configuration.submissionQueueIdle = toNumber<unsigned int>(name, value, sourceLocation);
+        } else if (name == "--napi-busy-poll") {
+            configuration.busyPollTimeout = toNumber<unsigned int>(name, value, sourceLocation);
+        } else if (name == "--napi-prefer-busy-poll") configuration.isPreferBusyPoll = true;
+        else if (name == "--balance-threshold") {
+            configuration.balanceThreshold = toNumber<unsigned long>(name, value, sourceLocation);
+        } else if (name == "--offload-threads") {
+            configuration.workerCount = toNumber<unsigned int>(name, value, sourceLocation);
+        } else if (name == "--connections") {
+            configuration.connectionCount = toNumber<unsigned int>(name, value, sourceLocation);
+        } else if (name == "--frame-budget") {
+            configuration.frameBudget = toNumber<unsigned int>(name, value, sourceLocation);
+        } else if (name == "--max-connections") {
+            configuration.connectionLimit = toNumber<unsigned int>(name, value, sourceLocation);
+        } else if (name == "--memory-watermark") {
+            configuration.memoryWatermark = toNumber<unsigned long>(name, value, sourceLocation);
+        } else if (name == "--shed-tasks") {
+            configuration.shedTaskLimit = toNumber<unsigned long>(name, value, sourceLocation);
+        } else if (name == "--shed-logs") {
+            configuration.shedLogLimit = toNumber<unsigned long>(name, value, sourceLocation);
+        } else if (name == "--shed-latency") {
+            configuration.shedLatencyLimit =
+                std::chrono::milliseconds{toNumber<unsigned long>(name, value, sourceLocation)};
+        } else if (name == "--log-ioprio") configuration.logPriority = toPriority(name, value, sourceLocation);
+        else if (name == "--capture") configuration.capturePath = value;
+        else if (name == "--listen") configuration.listenAddresses.emplace_back(value);
+        else if (name == "--certificate") configuration.certificatePath = value;
+        else if (name == "--private-key") configuration.privateKeyPath = value;
+        else {
+            throw Exception{
+                Log{Log::Level::fatal, std::format("unknown option: {}", argument), sourceLocation}
+            };
+        }
+    }
+
+    if (configuration.listenAddresses.empty()) configuration.listenAddresses.emplace_back("127.0.0.1:8080");
+
+    if (configuration.certificatePath.empty() != configuration.privateKeyPath.empty()) {
+        throw Exception{
+            Log{Log::Level::fatal, "https needs both --certificate and --private-key", sourceLocation}
+        };
+    }
+
+    return configuration;
+}
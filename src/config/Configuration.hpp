@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <source_location>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Configuration {
+    [[nodiscard]] static auto parse(std::span<const char *const> arguments,
+                                    std::source_location sourceLocation = std::source_location::current())
+        -> Configuration;
+
+    bool isSubmissionQueuePolling{}, isSubmissionQueueShared{}, isPreferBusyPoll{};
+    int submissionQueueCpu{-1};
+    unsigned int submissionQueueIdle{1000}, busyPollTimeout{},
+        workerCount{std::max(std::thread::hardware_concurrency() / 4, 1U)}, connectionCount{2048}, frameBudget{256},
+        connectionLimit{};
+    unsigned short logPriority{};
+    unsigned long balanceThreshold{}, memoryWatermark{}, shedTaskLimit{}, shedLogLimit{};
+    std::chrono::milliseconds shedLatencyLimit{};
+    std::string capturePath, certificatePath, privateKeyPath;
+    std::vector<std::string> listenAddresses;
+};
@@ -3,9 +3,15 @@
 Awaiter::Awaiter(const Submission &submission) noexcept : submission{submission} {}
 
 auto Awaiter::await_suspend(const std::coroutine_handle<Task::promise_type> handle) -> void {
-    this->handle = handle;
-    this->submission.userData = std::hash<std::coroutine_handle<Task::promise_type>>{}(this->handle);
-    this->handle.promise().setSubmission(this->submission);
+    this->suspend(handle, handle);
 }
 
 auto Awaiter::await_resume() const -> Outcome { return this->handle.promise().getOutcome(); }
+
+auto Awaiter::suspend(const std::coroutine_handle<Task::promise_type> rootHandle,
+                      const std::coroutine_handle<> currentHandle) -> void {
+    this->handle = rootHandle;
+    this->submission.userData = reinterpret_cast<unsigned long>(this->handle.address());
+    this->handle.promise().setSubmission(this->submission);
+    this->handle.promise().setCurrentHandle(currentHandle);
+}
@@ -10,9 +10,16 @@ public:
 
     auto await_suspend(std::coroutine_handle<Task::promise_type> handle) -> void;
 
+    template<typename Promise>
+    auto await_suspend(const std::coroutine_handle<Promise> handle) -> void {
+        this->suspend(handle.promise().getRootHandle(), handle);
+    }
+
     [[nodiscard]] auto await_resume() const -> Outcome;
 
 private:
+    auto suspend(std::coroutine_handle<Task::promise_type> rootHandle, std::coroutine_handle<> currentHandle) -> void;
+
     std::coroutine_handle<Task::promise_type> handle;
     Submission submission;
 };
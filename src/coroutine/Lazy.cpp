@@ -0,0 +1,19 @@
+#include "Lazy.hpp"
+
+auto LazyPromise::unhandled_exception() noexcept -> void { this->exception = std::current_exception(); }
+
+auto LazyPromise::setCaller(const std::coroutine_handle<Task::promise_type> rootHandle,
+                            const std::coroutine_handle<> continuation) noexcept -> void {
+    this->rootHandle = rootHandle;
+    this->continuation = continuation;
+}
+
+auto LazyPromise::getRootHandle() const noexcept -> std::coroutine_handle<Task::promise_type> {
+    return this->rootHandle;
+}
+
+auto LazyPromise::getContinuation() const noexcept -> std::coroutine_handle<> { return this->continuation; }
+
+auto LazyPromise::rethrowException() const -> void {
+    if (this->exception) std::rethrow_exception(this->exception);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Task.hpp"
+
+#include <exception>
+#include <optional>
+#include <utility>
+
+class LazyPromise {
+public:
+    class FinalAwaiter {
+    public:
+        [[nodiscard]] constexpr auto await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        [[nodiscard]] auto await_suspend(const std::coroutine_handle<Promise> handle) const noexcept
+            -> std::coroutine_handle<> {
+            return handle.promise().getContinuation();
+        }
+
+        constexpr auto await_resume() const noexcept -> void {}
+    };
+
+    [[nodiscard]] constexpr auto initial_suspend() const noexcept { return std::suspend_always{}; }
+
+    [[nodiscard]] constexpr auto final_suspend() const noexcept { return FinalAwaiter{}; }
+
+    auto unhandled_exception() noexcept -> void;
+
+    auto setCaller(std::coroutine_handle<Task::promise_type> rootHandle, std::coroutine_handle<> continuation) noexcept
+        -> void;
+
+    [[nodiscard]] auto getRootHandle() const noexcept -> std::coroutine_handle<Task::promise_type>;
+
+    [[nodiscard]] auto getContinuation() const noexcept -> std::coroutine_handle<>;
+
+protected:
+    auto rethrowException() const -> void;
+
+private:
+    std::coroutine_handle<Task::promise_type> rootHandle;
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+};
+
+template<typename T>
+class LazyResult : public LazyPromise {
+public:
+    auto return_value(T value) -> void { this->value.emplace(std::move(value)); }
+
+    [[nodiscard]] auto takeValue() -> T {
+        this->rethrowException();
+
+        return std::move(*this->value);
+    }
+
+private:
+    std::optional<T> value;
+};
+
+template<>
+class LazyResult<void> : public LazyPromise {
+public:
+    constexpr auto return_void() const noexcept -> void {}
+
+    auto takeValue() const -> void { this->rethrowException(); }
+};
+
+template<typename T = void>
+class Lazy {
+public:
+    class promise_type : public LazyResult<T> {
+    public:
+        [[nodiscard]] auto get_return_object() -> Lazy {
+            return Lazy{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+    };
+
+    explicit Lazy(const std::coroutine_handle<promise_type> handle) noexcept : handle{handle} {}
+
+    Lazy(const Lazy &) = delete;
+
+    Lazy(Lazy &&other) noexcept : handle{std::exchange(other.handle, nullptr)} {}
+
+    auto operator=(const Lazy &) -> Lazy & = delete;
+
+    auto operator=(Lazy &&other) noexcept -> Lazy & {
+        if (this == &other) return *this;
+
+        this->destroy();
+
+        this->handle = std::exchange(other.handle, nullptr);
+
+        return *this;
+    }
+
+    ~Lazy() { this->destroy(); }
+
+    [[nodiscard]] constexpr auto await_ready() const noexcept { return false; }
+
+    [[nodiscard]] auto await_suspend(const std::coroutine_handle<Task::promise_type> caller) const noexcept
+        -> std::coroutine_handle<> {
+        this->handle.promise().setCaller(caller, caller);
+
+        return this->handle;
+    }
+
+    template<typename Promise>
+    [[nodiscard]] auto await_suspend(const std::coroutine_handle<Promise> caller) const noexcept
+        -> std::coroutine_handle<> {
+        this->handle.promise().setCaller(caller.promise().getRootHandle(), caller);
+
+        return this->handle;
+    }
+
+    auto await_resume() const -> T { return this->handle.promise().takeValue(); }
+
+private:
+    auto destroy() const -> void {
+        if (this->handle) this->handle.destroy();
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
@@ -1,12 +1,44 @@
 #include "Scheduler.hpp"
 
 #include "../fileDescriptor/Client.hpp"
+#include "../fileDescriptor/Notifier.hpp"
 #include "../log/Exception.hpp"
+#include "../metric/Metrics.hpp"
+#include "../metric/Tracer.hpp"
 #include "../ring/Completion.hpp"
 #include "../ring/Ring.hpp"
+#include "../tls/TlsHandshake.hpp"
 
+#include <bit>
+#include <limits>
+#include <linux/tls.h>
+#include <netinet/tcp.h>
 #include <ranges>
+#include <sched.h>
 #include <sys/resource.h>
+#include <unistd.h>
+#include <utility>
+
+[[nodiscard]] static auto createMetricsResponse(const std::span<const Metrics> metrics) -> std::vector<std::byte> {
+    const std::string body{Metrics::format(metrics)};
+
+    HttpResponse httpResponse;
+    httpResponse.setVersion("HTTP/1.1");
+    httpResponse.setStatusCode("200 OK");
+    httpResponse.addHeader("Content-Type: text/plain; version=0.0.4; charset=utf-8");
+    httpResponse.addHeader("Content-Length: " + std::to_string(body.size()));
+    httpResponse.setBody(std::as_bytes(std::span{body}));
+
+    return httpResponse.toByte();
+}
+
+Scheduler::Work::Work(std::vector<std::byte> &&request, const bool isMessage,
+                      const int notifierFileDescriptor) noexcept :
+    request{std::move(request)}, isMessage{isMessage}, notifierFileDescriptor{notifierFileDescriptor} {}
+
+Scheduler::Work::~Work() {
+    if (this->notifierFileDescriptor != -1) ::close(this->notifierFileDescriptor);
+}
 
 auto Scheduler::getFileDescriptorLimit(const std::source_location sourceLocation) -> unsigned long {
     rlimit limit{};
@@ -19,6 +51,17 @@ auto Scheduler::getFileDescriptorLimit(const std::source_location sourceLocation
     return limit.rlim_cur;
 }
 
+auto Scheduler::setThreadAffinity(const unsigned int cpuCode, const std::source_location sourceLocation) -> void {
+    cpu_set_t cpuSet{};
+    CPU_SET(cpuCode, &cpuSet);
+
+    if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == -1) {
+        throw Exception{
+            Log{Log::Level::fatal, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
+        };
+    }
+}
+
 auto Scheduler::registerSignal(const std::source_location sourceLocation) -> void {
     struct sigaction signalAction {};
 
@@ -35,83 +78,335 @@ auto Scheduler::registerSignal(const std::source_location sourceLocation) -> voi
             Log{Log::Level::fatal, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
         };
     }
+
+#ifdef WEBSERVER_TRACING
+    struct sigaction dumpAction {};
+
+    dumpAction.sa_handler = [](int) noexcept { Tracer::requestDump(); };
+
+    if (sigaction(SIGUSR1, &dumpAction, nullptr) == -1) {
+        throw Exception{
+            Log{Log::Level::fatal, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
+        };
+    }
+#endif
 }
 
-Scheduler::Scheduler(const int sharedFileDescriptor, const unsigned int cpuCode) :
-    ring{[sharedFileDescriptor] {
+Scheduler::Scheduler(const Configuration &configuration, const int sharedFileDescriptor, const unsigned int cpuCode,
+                     const std::span<const int> serverFileDescriptors, const std::shared_ptr<WorkerPool> &workerPool) :
+    cpuCode{cpuCode}, connectionLimit{configuration.connectionLimit}, balanceThreshold{configuration.balanceThreshold},
+    memoryWatermark{configuration.memoryWatermark}, logPriority{configuration.logPriority},
+    isCapturing{!configuration.capturePath.empty()},
+    budgets{[&configuration] {
+        // the control plane is never deferred, a flood of accepts only takes a quarter of the data plane budget
+        std::array<unsigned int, taskClassCount> budgets;
+        budgets.fill(std::numeric_limits<unsigned int>::max());
+        if (configuration.frameBudget != 0) {
+            budgets[std::to_underlying(TaskClass::accept)] = std::max(configuration.frameBudget / 4, 1U);
+            budgets[std::to_underlying(TaskClass::receive)] = configuration.frameBudget;
+            budgets[std::to_underlying(TaskClass::send)] = configuration.frameBudget;
+        }
+
+        return budgets;
+    }()},
+    workerPool{workerPool},
+    ring{[&configuration, sharedFileDescriptor, cpuCode] {
         io_uring_params params{};
-        params.flags = IORING_SETUP_CLAMP | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN |
-                       IORING_SETUP_TASKRUN_FLAG | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+        params.flags = IORING_SETUP_CLAMP | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER;
 
-        if (sharedFileDescriptor != -1) {
+        if (configuration.isSubmissionQueuePolling) {
+            // task work is run by the kernel poller, so the taskrun flags are rejected in this mode
+            params.flags |= IORING_SETUP_SQPOLL;
+            params.sq_thread_idle = configuration.submissionQueueIdle;
+
+            // an unshared poller per scheduler starts from the given cpu and takes the next one each, so they do not
+            // all spin on the same core, while a shared poller is only made by the first ring and keeps the cpu as is
+            if (configuration.submissionQueueCpu != -1) {
+                params.flags |= IORING_SETUP_SQ_AFF;
+                params.sq_thread_cpu = configuration.isSubmissionQueueShared
+                                           ? configuration.submissionQueueCpu
+                                           : (configuration.submissionQueueCpu + cpuCode) %
+                                                 std::thread::hardware_concurrency();
+            }
+        } else {
+            params.flags |= IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG | IORING_SETUP_DEFER_TASKRUN;
+        }
+
+        // attaching a polling ring to another one also shares its kernel poller
+        if (sharedFileDescriptor != -1 &&
+            (!configuration.isSubmissionQueuePolling || configuration.isSubmissionQueueShared)) {
             params.wq_fd = sharedFileDescriptor;
             params.flags |= IORING_SETUP_ATTACH_WQ;
         }
 
-        auto ring{std::make_shared<Ring>(2048 / std::thread::hardware_concurrency(), params)};
+        // a connection has at most a receive and a send in flight, and a zero copy send completes twice
+        const unsigned int submissionCount{std::bit_ceil(
+            std::clamp(configuration.connectionCount / std::thread::hardware_concurrency(), 64U, 32768U))};
+        params.flags |= IORING_SETUP_CQSIZE;
+        params.cq_entries = submissionCount * 4;
+
+        auto ring{std::make_shared<Ring>(submissionCount, params)};
 
         return ring;
-    }()} {
+    }()},
+    servers{[&configuration] {
+        // the listeners follow the logger, the timer and the capture file in the fixed file table
+        std::vector<Server> servers;
+        for (unsigned int i{}; i != configuration.listenAddresses.size(); ++i)
+            servers.emplace_back(static_cast<int>(3 + i), Server::isUnixAddress(configuration.listenAddresses[i]));
+
+        return servers;
+    }()},
+    tlsContext{configuration.certificatePath.empty() ?
+                   nullptr :
+                   std::make_unique<TlsContext>(configuration.certificatePath, configuration.privateKeyPath)},
+    shedder{configuration.shedTaskLimit, configuration.shedLogLimit, configuration.shedLatencyLimit} {
     const unsigned long fileDescriptorLimit{getFileDescriptorLimit()};
 
     this->ring->registerSelfFileDescriptor();
     this->ring->registerCpu(cpuCode);
     this->ring->registerSparseFileDescriptor(fileDescriptorLimit);
 
-    const std::array fileDescriptors{Logger::create("log.log"), Server::create("127.0.0.1", 8080), Timer::create()};
+    if (configuration.busyPollTimeout != 0) {
+        try {
+            this->ring->registerNapi(configuration.busyPollTimeout, configuration.isPreferBusyPoll);
+            metrics[this->cpuCode].setNapi(true);
+
+            this->logger->push(Log{
+                Log::Level::info, std::format("napi busy poll enabled: {}us, prefer busy poll: {}",
+                                              configuration.busyPollTimeout, configuration.isPreferBusyPoll)
+            });
+        } catch (Exception &exception) {
+            // older kernels lack the registration, the server keeps running with interrupt driven receives
+            this->logger->push(std::move(exception.getLog()));
+        }
+    }
+
+    // an empty slot stands in for the capture file when capturing is off
+    std::vector fileDescriptors{
+        Logger::create("log.log"), Timer::create(),
+        this->isCapturing ? Recorder::create(std::format("{}.{}", configuration.capturePath, cpuCode)) : -1};
+    fileDescriptors.insert(fileDescriptors.cend(), serverFileDescriptors.cbegin(), serverFileDescriptors.cend());
     this->ring->allocateFileDescriptorRange(fileDescriptors.size(), fileDescriptorLimit - fileDescriptors.size());
     this->ring->updateFileDescriptors(0, fileDescriptors);
 
     for (unsigned int i{}; i != entries; ++i) this->ringBuffer.addBuffer(this->bufferGroup.getBuffer(i), i);
+
+    peers[this->cpuCode].ringFileDescriptor.store(this->ring->getFileDescriptor(), std::memory_order::relaxed);
 }
 
 Scheduler::~Scheduler() {
+    peers[this->cpuCode].ringFileDescriptor.store(-1, std::memory_order::relaxed);
+
+    for (const int fileDescriptor : this->notifiers) ::close(fileDescriptor);
+
+    // what was captured since the last write goes out before the file is closed
+    if (this->recorder.isWritable()) {
+        this->submit(std::make_shared<Task>(this->capture()));
+        this->ring->wait(1);
+        this->frame();
+    }
+
     for (const auto &client : this->clients | std::views::values)
         this->submit(std::make_shared<Task>(this->close(client.getFileDescriptor())));
     this->submit(std::make_shared<Task>(this->close(this->timer.getFileDescriptor())));
-    this->submit(std::make_shared<Task>(this->close(this->server.getFileDescriptor())));
+    for (const Server &server : this->servers)
+        this->submit(std::make_shared<Task>(this->close(server.getFileDescriptor())));
     this->submit(std::make_shared<Task>(this->close(this->logger->getFileDescriptor())));
+    if (this->isCapturing) this->submit(std::make_shared<Task>(this->close(this->recorder.getFileDescriptor())));
 
-    this->ring->wait(3 + this->clients.size());
+    this->ring->wait(2 + this->servers.size() + this->isCapturing + this->clients.size());
     this->frame();
 }
 
 auto Scheduler::getRingFileDescriptor() const noexcept -> int { return this->ring->getFileDescriptor(); }
 
 auto Scheduler::run() -> void {
-    this->submit(std::make_shared<Task>(this->accept()));
+    // pinning happens here rather than at construction, so threads spawned meanwhile and the kernel poller created
+    // with the ring don't inherit this single cpu
+    setThreadAffinity(this->cpuCode);
+
+    for (const Server &server : this->servers) this->submit(std::make_shared<Task>(this->accept(server)));
     this->submit(std::make_shared<Task>(this->timing()));
 
     while (switcher.test(std::memory_order::relaxed)) {
-        if (this->logger->isWritable()) this->submit(std::make_shared<Task>(this->write()));
+        // logs can wait while the submission queue overflows
+        if (this->logger->isWritable() && !this->ring->isCongested())
+            this->submit(std::make_shared<Task>(this->write()));
+        if (this->recorder.isWritable() && !this->ring->isCongested())
+            this->submit(std::make_shared<Task>(this->capture()));
 
-        this->ring->wait(1);
+        // deferred completions are handled without blocking for new ones, and only a blocking wait is timed, as
+        // that is where napi busy polls the device queues instead of sleeping
+        if (this->deferredCompletions.empty()) {
+            const auto start{std::chrono::steady_clock::now()};
+            this->ring->wait(1);
+            metrics[this->cpuCode].addWait(std::chrono::steady_clock::now() - start);
+        } else this->ring->wait(0);
         this->frame();
+
+#ifdef WEBSERVER_TRACING
+        if (Tracer::isDumpRequested()) {
+            try {
+                this->logger->push(Log{Log::Level::info, "trace written to " + Tracer::dump(this->cpuCode)});
+            } catch (Exception &exception) {
+                this->logger->push(std::move(exception.getLog()));
+            }
+        }
+#endif
     }
 }
 
 auto Scheduler::frame() -> void {
-    const int completionCount{this->ring->poll([this](const Completion &completion) {
-        if (completion.outcome.result != 0 || (completion.outcome.flags & IORING_CQE_F_NOTIF) == 0) {
-            this->currentUserData = completion.userData;
-            const std::shared_ptr task{this->tasks.at(this->currentUserData)};
-            task->resume(completion.outcome);
-        }
-    })};
+    TRACE_SCOPE("frame");
+
+    std::array<unsigned int, taskClassCount> usages{};
+
+    // completions deferred by the last frame go first, so that every task still sees its completions in order
+    for (unsigned long i{this->deferredCompletions.size()}; i != 0; --i) {
+        const Completion completion{this->deferredCompletions.front()};
+        this->deferredCompletions.pop_front();
+
+        this->dispatch(completion, usages);
+    }
+
+    const int completionCount{
+        this->ring->poll([this, &usages](const Completion &completion) { this->dispatch(completion, usages); })};
+
+    // finished tasks are destroyed after the batch, a task can't free its own frame while it is running
+    for (const unsigned long userData : this->finishedTasks) this->tasks.erase(userData);
+    this->finishedTasks.clear();
+
+    Metrics &schedulerMetrics{metrics[this->cpuCode]};
+    schedulerMetrics.addFrame(completionCount);
+    schedulerMetrics.setGauges(this->clients.size(), this->tasks.size(), this->logger->getBacklog());
 
     this->ring->advance(this->ringBuffer.getHandle(), completionCount, this->ringBuffer.getAddedBufferCount());
 }
 
+auto Scheduler::dispatch(const Completion &completion, std::array<unsigned int, taskClassCount> &usages) -> void {
+    if ((completion.userData & migration) != 0) {
+        // a migrated connection finished its handshake before it was moved
+        if (completion.outcome.result >= 0) {
+            const std::chrono::seconds seconds{completion.userData & ~(migration | zeroCopy)};
+            const bool isZeroCopy{(completion.userData & zeroCopy) != 0};
+            this->submit(
+                std::make_shared<Task>(this->receive(this->addClient(completion.outcome.result, seconds, isZeroCopy))));
+        }
+
+        return;
+    }
+
+    if (completion.outcome.result == 0 && (completion.outcome.flags & IORING_CQE_F_NOTIF) != 0) return;
+
+    Task::promise_type &promise{Task::getPromise(completion.userData)};
+
+    // a class that used up its budget waits for the next frame, its buffers stay valid until its task re-adds them
+    const auto taskClass{std::to_underlying(this->classify(promise.getSubmission()))};
+    if (usages[taskClass] == this->budgets[taskClass]) {
+        this->deferredCompletions.emplace_back(completion);
+
+        return;
+    }
+    ++usages[taskClass];
+
+    TRACE_SCOPE("resume");
+    TRACE_PROBE(resume, completion.userData, completion.outcome.result, completion.outcome.flags);
+
+    this->currentUserData = completion.userData;
+    promise.resume(completion.outcome);
+
+    // a task awaiting its next request after the first one has to submit it on its own
+    if (promise.isSubmissionPending()) this->ring->submit(promise.takeSubmission());
+}
+
+auto Scheduler::classify(const Submission &submission) const noexcept -> TaskClass {
+    switch (static_cast<Submission::Type>(submission.parameter.index())) {
+        case Submission::Type::write:
+            return TaskClass::log;
+        case Submission::Type::accept:
+            return TaskClass::accept;
+        case Submission::Type::read:
+            return (submission.flags & IOSQE_FIXED_FILE) != 0 &&
+                           submission.fileDescriptor == this->timer.getFileDescriptor() ?
+                       TaskClass::timer :
+                       TaskClass::other;
+        case Submission::Type::receive:
+            return TaskClass::receive;
+        case Submission::Type::send:
+            return TaskClass::send;
+        default:
+            return TaskClass::other;
+    }
+}
+
 auto Scheduler::submit(std::shared_ptr<Task> &&task) -> void {
     task->resume(Outcome{});
-    this->ring->submit(task->getSubmission());
+    this->ring->submit(task->takeSubmission());
     this->tasks.emplace(task->getSubmission().userData, std::move(task));
 }
 
-auto Scheduler::eraseCurrentTask() -> void { this->tasks.erase(this->currentUserData); }
+auto Scheduler::eraseCurrentTask() -> void { this->finishedTasks.emplace_back(this->currentUserData); }
+
+auto Scheduler::addClient(const int fileDescriptor, const std::chrono::seconds seconds, const bool isZeroCopy)
+    -> Client & {
+    this->clients.emplace(fileDescriptor, Client{fileDescriptor, seconds, isZeroCopy});
+
+    Client &client{this->clients.at(fileDescriptor)};
+
+    this->timer.add(fileDescriptor, client.getSeconds());
+
+    return client;
+}
+
+auto Scheduler::balance() -> void {
+    unsigned long load{}, heaviestTraffic{};
+    Client *heaviest{};
+    for (auto &client : this->clients | std::views::values) {
+        const unsigned long traffic{client.exchangeTraffic()};
+        load += traffic;
+
+        // a connection is only moved between responses, cancelling an in-flight send would cut the response and a
+        // request still with the worker pool would be answered on a descriptor that is gone, and http/2 and
+        // websocket connections keep their framing state here, a handshake its state as well
+        if (traffic > heaviestTraffic && !client.isSending() && !client.isOffloading() &&
+            !this->migrations.contains(client.getFileDescriptor()) &&
+            !this->sessions.contains(client.getFileDescriptor()) &&
+            !this->webSockets.contains(client.getFileDescriptor()) &&
+            !this->handshakes.contains(client.getFileDescriptor())) {
+            heaviestTraffic = traffic;
+            heaviest = &client;
+        }
+    }
+
+    peers[this->cpuCode].load.store(load, std::memory_order::relaxed);
+
+    if (this->balanceThreshold == 0 || load < this->balanceThreshold || heaviest == nullptr) return;
+
+    unsigned int target{this->cpuCode};
+    unsigned long targetLoad{load};
+    for (unsigned int i{}; i != peers.size(); ++i) {
+        if (const unsigned long peerLoad{peers[i].load.load(std::memory_order::relaxed)};
+            peerLoad < targetLoad && peers[i].ringFileDescriptor.load(std::memory_order::relaxed) != -1) {
+            target = i;
+            targetLoad = peerLoad;
+        }
+    }
+
+    // the move has to leave the target below the current load, otherwise the connection would just bounce back
+    if (target != this->cpuCode && targetLoad + heaviestTraffic < load) {
+        this->migrations.emplace(heaviest->getFileDescriptor(), target);
+        this->submit(std::make_shared<Task>(this->cancel(*heaviest)));
+    }
+}
+
+auto Scheduler::isOverloaded() const noexcept -> bool {
+    return (this->connectionLimit != 0 && this->clients.size() >= this->connectionLimit) ||
+           (this->memoryWatermark != 0 && this->sendingBytes >= this->memoryWatermark);
+}
 
 auto Scheduler::write(const std::source_location sourceLocation) -> Task {
-    if (const auto [result, flags]{co_await this->logger->write()}; result < 0) {
+    if (const auto [result, flags]{co_await this->logger->write(this->logPriority)}; result < 0) {
         throw Exception{
             Log{Log::Level::error, std::error_code{std::abs(result), std::generic_category()}.message(),
                 sourceLocation}
@@ -122,25 +417,55 @@ auto Scheduler::write(const std::source_location sourceLocation) -> Task {
     this->eraseCurrentTask();
 }
 
-auto Scheduler::accept(const std::source_location sourceLocation) -> Task {
-    while (true) {
-        if (const auto [result, flags]{co_await this->server.accept()};
-            result >= 0 && (flags & IORING_CQE_F_MORE) != 0) {
-            this->clients.emplace(result, Client{result, std::chrono::seconds{60}});
+auto Scheduler::capture(const std::source_location sourceLocation) -> Task {
+    if (const auto [result, flags]{co_await this->recorder.write()}; result < 0) {
+        throw Exception{
+            Log{Log::Level::error, std::error_code{std::abs(result), std::generic_category()}.message(),
+                sourceLocation}
+        };
+    }
+    this->recorder.wrote();
 
-            const Client &client{this->clients.at(result)};
+    this->eraseCurrentTask();
+}
 
-            this->timer.add(result, client.getSeconds());
-            this->submit(std::make_shared<Task>(this->receive(client)));
-        } else {
-            this->eraseCurrentTask();
+auto Scheduler::accept(const Server &server, const std::source_location sourceLocation) -> Task {
+    this->acceptingServers.emplace(server.getFileDescriptor());
 
-            throw Exception{
-                Log{Log::Level::error, std::error_code{std::abs(result), std::generic_category()}.message(),
-                    sourceLocation}
-            };
+    while (true) {
+        const auto [result, flags]{co_await server.accept()};
+        if (result >= 0) {
+            // connections that were already queued when accepting was paused are turned away right away
+            if (this->isOverloaded()) this->submit(std::make_shared<Task>(this->shed(result, !server.isUnix())));
+            else {
+                // a unix listener serves a proxy on the same host, its connections stay in plain text, and ktls
+                // rejects the MSG_ZEROCOPY of a zero copy send, so encrypted connections copy
+                Client &client{this->addClient(result, std::chrono::seconds{60},
+                                               this->tlsContext == nullptr && !server.isUnix())};
+                this->submit(std::make_shared<Task>(this->tlsContext == nullptr || server.isUnix() ?
+                                                        this->receive(client) :
+                                                        this->handshake(client)));
+            }
+        } else if (result != -ECANCELED) {
+            this->logger->push(Log{
+                Log::Level::warn, std::error_code{std::abs(result), std::generic_category()}
+                 .message(), sourceLocation
+            });
+        }
+
+        // a multishot accept that ended, e.g. on running out of file descriptors, is re-armed by the timer
+        if ((flags & IORING_CQE_F_MORE) == 0) break;
+
+        // the kernel keeps queueing new connections in the backlog meanwhile, where peers can still retry
+        if (!this->isAcceptPaused && this->isOverloaded()) {
+            this->isAcceptPaused = true;
+            for (const Server &element : this->servers) this->submit(std::make_shared<Task>(this->cancel(element)));
         }
     }
+
+    this->acceptingServers.erase(server.getFileDescriptor());
+
+    this->eraseCurrentTask();
 }
 
 auto Scheduler::timing(const std::source_location sourceLocation) -> Task {
@@ -148,6 +473,33 @@ auto Scheduler::timing(const std::source_location sourceLocation) -> Task {
         for (const auto fileDescriptor : this->timer.clearTimeout())
             this->submit(std::make_shared<Task>(this->cancel(this->clients.at(fileDescriptor))));
 
+        this->balance();
+
+        const unsigned int admission{this->shedder.getAdmission()};
+        this->shedder.update(this->tasks.size(), this->logger->getBacklog());
+        if (this->shedder.getAdmission() != admission) {
+            this->logger->push(Log{
+                Log::Level::warn,
+                std::format("load shedding: admitting {}/{} of requests", this->shedder.getAdmission(), Shedder::scale)
+            });
+        }
+
+        metrics[this->cpuCode].publishLatencies(this->latencies);
+
+        // one scheduler logs the merged distributions of all of them
+        if (this->cpuCode == 0 && ++this->tickCount % latencyLogInterval == 0) {
+            for (std::string &string : Metrics::mergeLatencies(metrics).toStrings())
+                this->logger->push(Log{Log::Level::info, std::move(string)});
+        }
+
+        if (this->acceptingServers.size() != this->servers.size() && !this->isOverloaded()) {
+            this->isAcceptPaused = false;
+            for (const Server &server : this->servers) {
+                if (!this->acceptingServers.contains(server.getFileDescriptor()))
+                    this->submit(std::make_shared<Task>(this->accept(server)));
+            }
+        }
+
         this->submit(std::make_shared<Task>(this->timing()));
     } else {
         throw Exception{
@@ -159,33 +511,68 @@ auto Scheduler::timing(const std::source_location sourceLocation) -> Task {
     this->eraseCurrentTask();
 }
 
-auto Scheduler::receive(const Client &client, const std::source_location sourceLocation) -> Task {
-    std::vector<std::byte> receiveBuffer;
+auto Scheduler::receive(Client &client, std::vector<std::byte> &&data, const std::source_location sourceLocation)
+    -> Task {
+    std::vector receiveBuffer{std::move(data)};
+    std::chrono::steady_clock::time_point firstByte;
 
     while (true) {
         if (const auto [result, flags]{co_await client.receive(this->ringBuffer.getId())};
             result > 0 && (flags & IORING_CQE_F_MORE) != 0) {
             const auto index{static_cast<unsigned short>(flags >> IORING_CQE_BUFFER_SHIFT)};
             const std::span buffer{this->bufferGroup.getBuffer(index)}, receivedData{buffer.first(result)};
-            this->ringBuffer.addBuffer(buffer, index);
+            if (this->isCapturing) [[unlikely]]
+                this->recorder.record(client.getFileDescriptor(), receivedData);
 
-            receiveBuffer.insert(receiveBuffer.cend(), receivedData.cbegin(), receivedData.cend());
+            if ((flags & IORING_CQE_F_SOCK_NONEMPTY) != 0) {
+                if (receiveBuffer.empty()) firstByte = std::chrono::steady_clock::now();
+                receiveBuffer.insert(receiveBuffer.cend(), receivedData.cbegin(), receivedData.cend());
+                this->ringBuffer.addBuffer(buffer, index);
 
-            if ((flags & IORING_CQE_F_SOCK_NONEMPTY) == 0) {
-                this->timer.update(client.getFileDescriptor(), client.getSeconds());
+                continue;
+            }
 
-                std::vector response{this->httpParse.parse(
-                    std::string_view{reinterpret_cast<const char *>(receiveBuffer.data()), receiveBuffer.size()})};
-                receiveBuffer.clear();
+            this->timer.update(client.getFileDescriptor(), client.getSeconds());
 
-                this->submit(std::make_shared<Task>(this->send(client, std::move(response))));
+            // the whole request usually sits in one provided buffer, then it is parsed in place and the buffer is
+            // only handed back to the ring once nothing references it any more
+            std::span<const std::byte> request{receivedData};
+            auto start{std::chrono::steady_clock::now()};
+            if (!receiveBuffer.empty()) [[unlikely]] {
+                receiveBuffer.insert(receiveBuffer.cend(), receivedData.cbegin(), receivedData.cend());
+                request = receiveBuffer;
+                start = firstByte;
             }
+
+            this->handle(client, request, start);
+
+            this->ringBuffer.addBuffer(buffer, index);
+            receiveBuffer.clear();
+        } else if (const auto element{this->migrations.find(client.getFileDescriptor())};
+                   result == -ECANCELED && element != this->migrations.cend()) {
+            // requests handled since balancing picked the connection may have started a send or an offload, and a
+            // half received request would be lost, in all those cases the connection stays here and receives again
+            if (receiveBuffer.empty() && !client.isSending() && !client.isOffloading()) [[likely]]
+                this->submit(std::make_shared<Task>(this->migrate(client, element->second)));
+            else {
+                this->migrations.erase(element);
+                this->submit(std::make_shared<Task>(this->receive(client, std::move(receiveBuffer))));
+            }
+
+            break;
         } else {
+            if (result == -ENOBUFS) metrics[this->cpuCode].addBufferStarvation();
+
+            // ktls hands a plain receive only application data, a record of another type such as the peer's
+            // close_notify alert fails it with EIO, and as alerts end a connection anyway it is closed like an eof
+            const bool isControlRecord{result == -EIO && this->tlsContext != nullptr && !client.isZeroCopy()};
+
+            this->migrations.erase(client.getFileDescriptor());
             this->logger->push(Log{
-                Log::Level::warn,
-                result == 0 ? "connection closed" :
-                              std::error_code{std::abs(result), std::generic_category()}
-                              .message(),
+                result == 0 || isControlRecord ? Log::Level::info : Log::Level::warn,
+                result == 0     ? "connection closed" :
+                isControlRecord ? "connection closed by a tls control record" :
+                                  std::error_code{std::abs(result), std::generic_category()}.message(),
                 sourceLocation
             });
 
@@ -199,10 +586,327 @@ auto Scheduler::receive(const Client &client, const std::source_location sourceL
     this->eraseCurrentTask();
 }
 
-auto Scheduler::send(const Client &client, std::vector<std::byte> &&data, const std::source_location sourceLocation)
+auto Scheduler::handle(Client &client, const std::span<const std::byte> request,
+                       const std::chrono::steady_clock::time_point start) -> void {
+    if (const auto webSocket{this->webSockets.find(client.getFileDescriptor())}; webSocket != this->webSockets.end())
+        [[unlikely]] {
+        this->converse(client, webSocket->second, request, start);
+
+        return;
+    }
+
+    const std::string_view requestView{reinterpret_cast<const char *>(request.data()), request.size()};
+    if (this->sessions.contains(client.getFileDescriptor()) ||
+        requestView.starts_with(Http2Session::preface.substr(0, 16))) [[unlikely]] {
+        this->serve(client, request, start);
+
+        return;
+    }
+
+    metrics[this->cpuCode].addRequest();
+
+    const LatencyTable::Route route{LatencyTable::getRoute(requestView)};
+    if (requestView.starts_with("GET /metrics ")) [[unlikely]]
+        this->submit(std::make_shared<Task>(this->send(client, createMetricsResponse(metrics), route, start)));
+    else if (this->shedder.isShedding()) [[unlikely]] {
+        metrics[this->cpuCode].addShedRequest();
+        this->submit(std::make_shared<Task>(this->reject(client, route, start)));
+    } else if (this->workerPool->getWorkerCount() != 0 && HttpParse::isExpensive(requestView)) {
+        // the work outlives the provided buffer, so it gets its own copy of the request
+        std::vector<std::byte> work{request.cbegin(), request.cend()};
+        this->submit(std::make_shared<Task>(this->offload(client.getFileDescriptor(), std::move(work), route, start)));
+    } else {
+        std::vector response{this->httpParse.parse(requestView)};
+
+        // frames follow right behind the upgrade, so the connection switches before the response is even sent
+        if (HttpParse::isSwitchingProtocols(response)) [[unlikely]]
+            this->webSockets.try_emplace(client.getFileDescriptor());
+
+        this->submit(std::make_shared<Task>(this->send(client, std::move(response), route, start)));
+    }
+}
+
+auto Scheduler::handshake(Client &client, const std::source_location sourceLocation) -> Task {
+    const int fileDescriptor{client.getFileDescriptor()};
+    this->handshakes.emplace(fileDescriptor);
+
+    bool isFailed{};
+    try {
+        TlsHandshake handshake{*this->tlsContext, sourceLocation};
+        std::vector<std::byte> buffer(16 * 1024);
+        for (bool isFinished{}; !isFinished;) {
+            const auto [result, flags]{co_await client.read(buffer)};
+            if (result <= 0) {
+                throw Exception{
+                    Log{Log::Level::warn,
+                        result == 0 ? "connection closed" :
+                                      std::error_code{std::abs(result), std::generic_category()}.message(),
+                        sourceLocation}
+                };
+            }
+
+            isFinished = handshake.advance(std::span{buffer}.first(result), sourceLocation);
+
+            if (const std::vector output{handshake.takeOutput()}; !output.empty()) {
+                if (const auto [sendResult, sendFlags]{co_await client.send(output)};
+                    sendResult != static_cast<int>(output.size())) {
+                    throw Exception{
+                        Log{Log::Level::warn, "sending of handshake failed", sourceLocation}
+                    };
+                }
+            }
+        }
+
+        // from here on the kernel encrypts what is sent and decrypts what is received, zero copy sends included
+        const std::vector data{handshake.takeData(sourceLocation)},
+            transmitInfo{handshake.getCryptoInfo(true, sourceLocation)},
+            receiveInfo{handshake.getCryptoInfo(false, sourceLocation)};
+        static constexpr std::string_view upperLayer{"tls"};
+        const std::array<std::tuple<int, int, std::span<const std::byte>>, 3> options{
+            {{SOL_TCP, TCP_ULP, std::as_bytes(std::span{upperLayer})},
+             {SOL_TLS, TLS_TX, transmitInfo},
+             {SOL_TLS, TLS_RX, receiveInfo}}
+        };
+        for (const auto &[level, name, value] : options) {
+            if (const auto [result, flags]{co_await client.setOption(level, name, value)}; result < 0) {
+                throw Exception{
+                    Log{Log::Level::warn,
+                        "kernel tls: " + std::error_code{std::abs(result), std::generic_category()}.message(),
+                        sourceLocation}
+                };
+            }
+        }
+
+        this->handshakes.erase(fileDescriptor);
+        this->submit(std::make_shared<Task>(this->receive(client)));
+        if (!data.empty()) this->handle(client, data, std::chrono::steady_clock::now());
+    } catch (Exception &exception) {
+        this->logger->push(std::move(exception.getLog()));
+        isFailed = true;
+    }
+
+    if (isFailed) {
+        this->handshakes.erase(fileDescriptor);
+        this->timer.remove(fileDescriptor);
+        this->submit(std::make_shared<Task>(this->close(fileDescriptor)));
+    }
+
+    this->eraseCurrentTask();
+}
+
+auto Scheduler::converse(Client &client, WebSocket &webSocket, const std::span<const std::byte> data,
+                         const std::chrono::steady_clock::time_point start) -> void {
+    for (std::string &message : webSocket.receive(data)) {
+        metrics[this->cpuCode].addRequest();
+
+        // every message is a database query, so the pool takes it whenever there is one
+        if (this->shedder.isShedding()) [[unlikely]] {
+            metrics[this->cpuCode].addShedRequest();
+            webSocket.close(WebSocket::CloseCode::tryAgainLater);
+        } else if (this->workerPool->getWorkerCount() != 0) {
+            this->submit(
+                std::make_shared<Task>(this->offload(client.getFileDescriptor(), std::move(message), start)));
+        } else webSocket.send(this->httpParse.parseMessage(message));
+    }
+
+    if (!client.isSending() && webSocket.hasOutput())
+        this->submit(std::make_shared<Task>(this->transmit(client.getFileDescriptor())));
+}
+
+auto Scheduler::serve(Client &client, const std::span<const std::byte> data,
+                      const std::chrono::steady_clock::time_point start) -> void {
+    Http2Session &session{this->sessions.try_emplace(client.getFileDescriptor()).first->second};
+
+    // the responses of all streams share the connection, so they are framed into the session and sent by transmit
+    for (auto &[streamId, request] : session.receive(data)) {
+        metrics[this->cpuCode].addRequest();
+
+        const LatencyTable::Route route{LatencyTable::getRoute(request)};
+        if (request.starts_with("GET /metrics ")) [[unlikely]]
+            session.respond(streamId, createMetricsResponse(metrics));
+        else if (this->shedder.isShedding()) [[unlikely]] {
+            metrics[this->cpuCode].addShedRequest();
+            session.respond(streamId, HttpParse::getUnavailableResponse(false));
+        } else if (this->workerPool->getWorkerCount() != 0 && HttpParse::isExpensive(request)) {
+            const std::span bytes{std::as_bytes(std::span{request})};
+            this->submit(std::make_shared<Task>(this->offload(client.getFileDescriptor(), streamId,
+                                                              std::vector<std::byte>{bytes.begin(), bytes.end()},
+                                                              route, start)));
+        } else {
+            const std::vector response{this->httpParse.parse(request)};
+            session.respond(streamId, response);
+            this->addResponse(route, response, start);
+        }
+    }
+
+    if (!client.isSending() && session.hasOutput())
+        this->submit(std::make_shared<Task>(this->transmit(client.getFileDescriptor())));
+}
+
+auto Scheduler::send(Client &client, std::vector<std::byte> &&data, const LatencyTable::Route route,
+                     const std::chrono::steady_clock::time_point start, const std::source_location sourceLocation)
     -> Task {
     const std::vector response{std::move(data)};
-    if (const auto [result, flags]{co_await client.send(response)}; result <= 0) {
+    const int fileDescriptor{client.getFileDescriptor()};
+    client.addTraffic(response.size());
+    client.startSending();
+    this->sendingBytes += response.size();
+
+    const auto [result, flags]{co_await client.send(response)};
+    this->finishSend(fileDescriptor, result, response.size(), sourceLocation);
+    if (result > 0) this->addResponse(route, response, start);
+
+    this->eraseCurrentTask();
+}
+
+auto Scheduler::offload(const int fileDescriptor, std::vector<std::byte> &&data, const LatencyTable::Route route,
+                        const std::chrono::steady_clock::time_point start, const std::source_location sourceLocation)
+    -> Task {
+    this->clients.at(fileDescriptor).startOffloading();
+    const std::vector response{co_await this->parse(std::move(data), false, sourceLocation)};
+    this->shedder.addLatency(std::chrono::steady_clock::now() - start);
+
+    // the connection may have been closed while the work was running
+    const auto element{this->clients.find(fileDescriptor)};
+    if (element != this->clients.end()) element->second.finishOffloading();
+
+    if (!response.empty() && element != this->clients.end()) {
+        if (HttpParse::isSwitchingProtocols(response)) [[unlikely]]
+            this->webSockets.try_emplace(fileDescriptor);
+
+        Client &client{element->second};
+        client.addTraffic(response.size());
+        client.startSending();
+        this->sendingBytes += response.size();
+
+        const auto [result, flags]{co_await client.send(response)};
+        this->finishSend(fileDescriptor, result, response.size(), sourceLocation);
+        if (result > 0) this->addResponse(route, response, start);
+    }
+
+    this->eraseCurrentTask();
+}
+
+auto Scheduler::offload(const int fileDescriptor, const unsigned int streamId, std::vector<std::byte> &&data,
+                        const LatencyTable::Route route, const std::chrono::steady_clock::time_point start,
+                        const std::source_location sourceLocation) -> Task {
+    const std::vector response{co_await this->parse(std::move(data), false, sourceLocation)};
+    this->shedder.addLatency(std::chrono::steady_clock::now() - start);
+
+    if (const auto element{this->sessions.find(fileDescriptor)}; !response.empty() && element != this->sessions.end()) {
+        element->second.respond(streamId, response);
+        this->addResponse(route, response, start);
+
+        if (!this->clients.at(fileDescriptor).isSending())
+            this->submit(std::make_shared<Task>(this->transmit(fileDescriptor)));
+    }
+
+    this->eraseCurrentTask();
+}
+
+auto Scheduler::offload(const int fileDescriptor, std::string &&message,
+                        const std::chrono::steady_clock::time_point start, const std::source_location sourceLocation)
+    -> Task {
+    const auto bytes{std::as_bytes(std::span{message})};
+    const std::vector reply{
+        co_await this->parse(std::vector<std::byte>{bytes.cbegin(), bytes.cend()}, true, sourceLocation)};
+    this->shedder.addLatency(std::chrono::steady_clock::now() - start);
+
+    if (const auto element{this->webSockets.find(fileDescriptor)};
+        !reply.empty() && element != this->webSockets.end() && !element->second.isClosed()) {
+        element->second.send(reply);
+
+        if (!this->clients.at(fileDescriptor).isSending())
+            this->submit(std::make_shared<Task>(this->transmit(fileDescriptor)));
+    }
+
+    this->eraseCurrentTask();
+}
+
+auto Scheduler::takeOutput(const int fileDescriptor) -> std::vector<std::byte> {
+    if (const auto session{this->sessions.find(fileDescriptor)}; session != this->sessions.end())
+        return session->second.takeOutput();
+    if (const auto webSocket{this->webSockets.find(fileDescriptor)}; webSocket != this->webSockets.end())
+        return webSocket->second.takeOutput();
+
+    return {};
+}
+
+auto Scheduler::transmit(const int fileDescriptor, const std::source_location sourceLocation) -> Task {
+    // one send at a time keeps the frames in order, whatever is framed meanwhile goes out with the next one
+    for (std::vector output{this->takeOutput(fileDescriptor)}; !output.empty();
+         output = this->takeOutput(fileDescriptor)) {
+        Client &client{this->clients.at(fileDescriptor)};
+        client.addTraffic(output.size());
+        client.startSending();
+        this->sendingBytes += output.size();
+
+        const auto [result, flags]{co_await client.send(output)};
+        this->finishSend(fileDescriptor, result, output.size(), sourceLocation);
+        if (result <= 0) break;
+
+        // the closing handshake is done once the close frame went out, the receive is cancelled and closes
+        if (const auto webSocket{this->webSockets.find(fileDescriptor)};
+            webSocket != this->webSockets.end() && webSocket->second.isClosed() && !webSocket->second.hasOutput())
+            this->submit(std::make_shared<Task>(this->cancel(this->clients.at(fileDescriptor))));
+    }
+
+    this->eraseCurrentTask();
+}
+
+auto Scheduler::parse(std::vector<std::byte> request, const bool isMessage, const std::source_location sourceLocation)
+    -> Lazy<std::vector<std::byte>> {
+    // the work owns its notifier until the job is done, so a notifier that failed or whose scheduler is gone is
+    // closed by whichever side lets go last, and never while the job may still notify it
+    const auto work{std::make_shared<Work>(std::move(request), isMessage, [this] {
+        if (this->notifiers.empty()) return Notifier::create();
+
+        const int notifierFileDescriptor{this->notifiers.back()};
+        this->notifiers.pop_back();
+
+        return notifierFileDescriptor;
+    }())};
+    Notifier notifier{work->notifierFileDescriptor};
+
+    this->workerPool->push([work, notifierFileDescriptor{work->notifierFileDescriptor}] {
+        // every worker thread keeps its own parser and database connection, its logs are handed back to the ring
+        thread_local const std::shared_ptr logger{std::make_shared<Logger>(-1)};
+        thread_local HttpParse httpParse{logger};
+
+        const std::string_view request{reinterpret_cast<const char *>(work->request.data()), work->request.size()};
+        work->response = work->isMessage ? httpParse.parseMessage(request) : httpParse.parse(request);
+        work->logs = logger->takeLogs();
+
+        Notifier::notify(notifierFileDescriptor);
+    });
+
+    if (const auto [result, flags]{co_await notifier.wait()}; result != sizeof(unsigned long)) [[unlikely]] {
+        this->logger->push(Log{
+            Log::Level::error, std::error_code{std::abs(result), std::generic_category()}
+             .message(), sourceLocation
+        });
+
+        co_return std::vector<std::byte>{};
+    }
+
+    this->notifiers.emplace_back(std::exchange(work->notifierFileDescriptor, -1));
+
+    for (Log &log : work->logs) this->logger->push(std::move(log));
+
+    co_return std::move(work->response);
+}
+
+auto Scheduler::finishSend(const int fileDescriptor, const int result, const unsigned long size,
+                           const std::source_location sourceLocation) -> void {
+    TRACE_PROBE(sendComplete, fileDescriptor, result, size);
+
+    this->sendingBytes -= size;
+
+    // the connection may have been closed by its receiving side meanwhile
+    if (const auto element{this->clients.find(fileDescriptor)}; element != this->clients.end())
+        element->second.finishSending();
+
+    if (result <= 0) {
         this->logger->push(Log{
             Log::Level::warn,
             result == 0 ? "connection closed" : std::error_code{std::abs(result), std::generic_category()}
@@ -210,15 +914,65 @@ auto Scheduler::send(const Client &client, std::vector<std::byte> &&data, const
             sourceLocation
         });
 
-        this->timer.remove(client.getFileDescriptor());
-        this->submit(std::make_shared<Task>(this->close(client.getFileDescriptor())));
+        this->timer.remove(fileDescriptor);
+        this->submit(std::make_shared<Task>(this->close(fileDescriptor)));
+    }
+}
+
+auto Scheduler::addResponse(const LatencyTable::Route route, const std::span<const std::byte> response,
+                            const std::chrono::steady_clock::time_point start) -> void {
+    const std::chrono::steady_clock::duration latency{std::chrono::steady_clock::now() - start};
+
+    metrics[this->cpuCode].addResponse(latency);
+    this->latencies.record(route, response, latency);
+}
+
+auto Scheduler::migrate(Client &client, const unsigned int target, const std::source_location sourceLocation) -> Task {
+    const int fileDescriptor{client.getFileDescriptor()},
+        ringFileDescriptor{peers[target].ringFileDescriptor.load(std::memory_order::relaxed)};
+
+    const auto [result, flags]{co_await client.migrate(
+        ringFileDescriptor, migration | (client.isZeroCopy() ? zeroCopy : 0) | client.getSeconds().count())};
+    this->migrations.erase(fileDescriptor);
+
+    if (result < 0) {
+        this->logger->push(Log{
+            Log::Level::warn, std::error_code{std::abs(result), std::generic_category()}
+             .message(), sourceLocation
+        });
+
+        this->submit(std::make_shared<Task>(this->receive(client)));
+    } else {
+        this->timer.remove(fileDescriptor);
+        this->submit(std::make_shared<Task>(this->close(fileDescriptor)));
+    }
+
+    this->eraseCurrentTask();
+}
+
+auto Scheduler::cancel(const FileDescriptor &fileDescriptor, const std::source_location sourceLocation) -> Task {
+    if (const auto [result, flags]{co_await fileDescriptor.cancel()}; result < 0) {
+        this->logger->push(Log{
+            Log::Level::warn, std::error_code{std::abs(result), std::generic_category()}
+             .message(), sourceLocation
+        });
     }
 
     this->eraseCurrentTask();
 }
 
-auto Scheduler::cancel(const Client &client, const std::source_location sourceLocation) -> Task {
-    if (const auto [result, flags]{co_await client.cancel()}; result < 0) {
+auto Scheduler::shed(const int fileDescriptor, const bool isZeroCopy, const std::source_location sourceLocation)
+    -> Task {
+    const Client client{fileDescriptor, std::chrono::seconds{}, isZeroCopy};
+
+    if (const auto [result, flags]{co_await client.send(HttpParse::getUnavailableResponse(true))}; result < 0) {
+        this->logger->push(Log{
+            Log::Level::warn, std::error_code{std::abs(result), std::generic_category()}
+             .message(), sourceLocation
+        });
+    }
+
+    if (const auto [result, flags]{co_await client.close()}; result < 0) {
         this->logger->push(Log{
             Log::Level::warn, std::error_code{std::abs(result), std::generic_category()}
              .message(), sourceLocation
@@ -228,14 +982,40 @@ auto Scheduler::cancel(const Client &client, const std::source_location sourceLo
     this->eraseCurrentTask();
 }
 
+auto Scheduler::reject(Client &client, const LatencyTable::Route route,
+                       const std::chrono::steady_clock::time_point start, const std::source_location sourceLocation)
+    -> Task {
+    const std::span response{HttpParse::getUnavailableResponse(false)};
+    const int fileDescriptor{client.getFileDescriptor()};
+    client.startSending();
+    this->sendingBytes += response.size();
+
+    const auto [result, flags]{co_await client.send(response)};
+    this->finishSend(fileDescriptor, result, response.size(), sourceLocation);
+    if (result > 0) this->latencies.record(route, response, std::chrono::steady_clock::now() - start);
+
+    this->eraseCurrentTask();
+}
+
 auto Scheduler::close(const int fileDescriptor, const std::source_location sourceLocation) -> Task {
     Outcome outcome;
     if (fileDescriptor == this->logger->getFileDescriptor()) outcome = co_await this->logger->close();
-    else if (fileDescriptor == this->server.getFileDescriptor()) outcome = co_await this->server.close();
+    else if (const auto server{std::ranges::find(this->servers, fileDescriptor, &Server::getFileDescriptor)};
+             server != this->servers.cend())
+        outcome = co_await server->close();
     else if (fileDescriptor == this->timer.getFileDescriptor()) outcome = co_await this->timer.close();
-    else [[likely]] {
-        outcome = co_await this->clients.at(fileDescriptor).close();
+    else if (fileDescriptor == this->recorder.getFileDescriptor()) outcome = co_await this->recorder.close();
+    else if (const auto element{this->clients.find(fileDescriptor)}; element != this->clients.end()) [[likely]] {
+        outcome = co_await element->second.close();
         this->clients.erase(fileDescriptor);
+        this->sessions.erase(fileDescriptor);
+        this->webSockets.erase(fileDescriptor);
+    } else {
+        // a connection can be closed from its receive and its send alike, the later close finds it gone, and as a
+        // task only ends from a completion it goes through a nop
+        outcome = co_await Awaiter{
+            Submission{-1, 0, 0, 0, Submission::Nop{}}
+        };
     }
 
     if (outcome.result < 0) {
@@ -250,5 +1030,7 @@ auto Scheduler::close(const int fileDescriptor, const std::source_location sourc
 }
 
 constinit std::atomic_flag Scheduler::switcher{true};
+std::vector<Scheduler::Peer> Scheduler::peers(std::thread::hardware_concurrency());
+std::vector<Metrics> Scheduler::metrics(std::thread::hardware_concurrency());
 const unsigned int Scheduler::entries{
     std::bit_ceil(static_cast<unsigned int>(getFileDescriptorLimit()) / std::thread::hardware_concurrency()) * 2};
@@ -1,22 +1,69 @@
 #pragma once
 
+#include "../config/Configuration.hpp"
 #include "../fileDescriptor/Logger.hpp"
+#include "../fileDescriptor/Recorder.hpp"
 #include "../fileDescriptor/Server.hpp"
 #include "../fileDescriptor/Timer.hpp"
+#include "../http/Http2Session.hpp"
 #include "../http/HttpParse.hpp"
+#include "../http/WebSocket.hpp"
+#include "../metric/LatencyTable.hpp"
 #include "../ring/BufferGroup.hpp"
+#include "../ring/Completion.hpp"
 #include "../ring/RingBuffer.hpp"
+#include "../tls/TlsContext.hpp"
+#include "Lazy.hpp"
+#include "Shedder.hpp"
+#include "WorkerPool.hpp"
+
+#include <deque>
+#include <unordered_set>
 
 class Client;
+class Metrics;
 
 class Scheduler {
+    enum class TaskClass : unsigned char { accept, receive, send, timer, log, other };
+
+    static constexpr unsigned long taskClassCount{std::to_underlying(TaskClass::other) + 1};
+
+    struct Peer {
+        std::atomic_int ringFileDescriptor{-1};
+        std::atomic_ulong load;
+    };
+
+    struct Work {
+        Work(std::vector<std::byte> &&request, bool isMessage, int notifierFileDescriptor) noexcept;
+
+        Work(const Work &) = delete;
+
+        Work(Work &&) = delete;
+
+        auto operator=(const Work &) -> Work & = delete;
+
+        auto operator=(Work &&) -> Work & = delete;
+
+        ~Work();
+
+        std::vector<std::byte> request;
+        bool isMessage;
+        std::vector<std::byte> response;
+        std::vector<Log> logs;
+        int notifierFileDescriptor;
+    };
+
     [[nodiscard]] static auto
         getFileDescriptorLimit(std::source_location sourceLocation = std::source_location::current()) -> unsigned long;
 
+    static auto setThreadAffinity(unsigned int cpuCode,
+                                  std::source_location sourceLocation = std::source_location::current()) -> void;
+
 public:
     static auto registerSignal(std::source_location sourceLocation = std::source_location::current()) -> void;
 
-    Scheduler(int sharedFileDescriptor, unsigned int cpuCode);
+    Scheduler(const Configuration &configuration, int sharedFileDescriptor, unsigned int cpuCode,
+              std::span<const int> serverFileDescriptors, const std::shared_ptr<WorkerPool> &workerPool);
 
     Scheduler(const Scheduler &) = delete;
 
@@ -35,39 +82,125 @@ public:
 private:
     auto frame() -> void;
 
+    auto dispatch(const Completion &completion, std::array<unsigned int, taskClassCount> &usages) -> void;
+
+    [[nodiscard]] auto classify(const Submission &submission) const noexcept -> TaskClass;
+
     auto submit(std::shared_ptr<Task> &&task) -> void;
 
     auto eraseCurrentTask() -> void;
 
+    auto addClient(int fileDescriptor, std::chrono::seconds seconds, bool isZeroCopy) -> Client &;
+
+    auto balance() -> void;
+
+    [[nodiscard]] auto isOverloaded() const noexcept -> bool;
+
     [[nodiscard]] auto write(std::source_location sourceLocation = std::source_location::current()) -> Task;
 
-    [[nodiscard]] auto accept(std::source_location sourceLocation = std::source_location::current()) -> Task;
+    [[nodiscard]] auto capture(std::source_location sourceLocation = std::source_location::current()) -> Task;
+
+    [[nodiscard]] auto accept(const Server &server,
+                              std::source_location sourceLocation = std::source_location::current()) -> Task;
 
     [[nodiscard]] auto timing(std::source_location sourceLocation = std::source_location::current()) -> Task;
 
-    [[nodiscard]] auto receive(const Client &client,
+    [[nodiscard]] auto receive(Client &client, std::vector<std::byte> &&data = {},
+                               std::source_location sourceLocation = std::source_location::current()) -> Task;
+
+    auto handle(Client &client, std::span<const std::byte> request, std::chrono::steady_clock::time_point start)
+        -> void;
+
+    [[nodiscard]] auto handshake(Client &client, std::source_location sourceLocation = std::source_location::current())
+        -> Task;
+
+    auto converse(Client &client, WebSocket &webSocket, std::span<const std::byte> data,
+                  std::chrono::steady_clock::time_point start) -> void;
+
+    auto serve(Client &client, std::span<const std::byte> data, std::chrono::steady_clock::time_point start) -> void;
+
+    [[nodiscard]] auto send(Client &client, std::vector<std::byte> &&data, LatencyTable::Route route,
+                            std::chrono::steady_clock::time_point start,
+                            std::source_location sourceLocation = std::source_location::current()) -> Task;
+
+    [[nodiscard]] auto offload(int fileDescriptor, std::vector<std::byte> &&data, LatencyTable::Route route,
+                               std::chrono::steady_clock::time_point start,
+                               std::source_location sourceLocation = std::source_location::current()) -> Task;
+
+    [[nodiscard]] auto offload(int fileDescriptor, unsigned int streamId, std::vector<std::byte> &&data,
+                               LatencyTable::Route route, std::chrono::steady_clock::time_point start,
+                               std::source_location sourceLocation = std::source_location::current()) -> Task;
+
+    [[nodiscard]] auto offload(int fileDescriptor, std::string &&message, std::chrono::steady_clock::time_point start,
                                std::source_location sourceLocation = std::source_location::current()) -> Task;
 
-    [[nodiscard]] auto send(const Client &client, std::vector<std::byte> &&data,
+    [[nodiscard]] auto takeOutput(int fileDescriptor) -> std::vector<std::byte>;
+
+    [[nodiscard]] auto transmit(int fileDescriptor,
+                                std::source_location sourceLocation = std::source_location::current()) -> Task;
+
+    [[nodiscard]] auto parse(std::vector<std::byte> request, bool isMessage = false,
+                             std::source_location sourceLocation = std::source_location::current())
+        -> Lazy<std::vector<std::byte>>;
+
+    auto addResponse(LatencyTable::Route route, std::span<const std::byte> response,
+                     std::chrono::steady_clock::time_point start) -> void;
+
+    auto finishSend(int fileDescriptor, int result, unsigned long size,
+                    std::source_location sourceLocation = std::source_location::current()) -> void;
+
+    [[nodiscard]] auto migrate(Client &client, unsigned int target,
+                               std::source_location sourceLocation = std::source_location::current()) -> Task;
+
+    [[nodiscard]] auto cancel(const FileDescriptor &fileDescriptor,
+                              std::source_location sourceLocation = std::source_location::current()) -> Task;
+
+    [[nodiscard]] auto shed(int fileDescriptor, bool isZeroCopy,
                             std::source_location sourceLocation = std::source_location::current()) -> Task;
 
-    [[nodiscard]] auto cancel(const Client &client,
+    [[nodiscard]] auto reject(Client &client, LatencyTable::Route route, std::chrono::steady_clock::time_point start,
                               std::source_location sourceLocation = std::source_location::current()) -> Task;
 
     [[nodiscard]] auto close(int fileDescriptor, std::source_location sourceLocation = std::source_location::current())
         -> Task;
 
     static constinit std::atomic_flag switcher;
+    static std::vector<Peer> peers;
+    static std::vector<Metrics> metrics;
     static const unsigned int entries;
-
+    // a migrated connection carries both flags and its keep-alive seconds in the user data of the message
+    static constexpr unsigned long migration{1UL << 63}, zeroCopy{1UL << 62};
+    static constexpr unsigned long latencyLogInterval{60};
+
+    const unsigned int cpuCode;
+    const unsigned int connectionLimit;
+    const unsigned long balanceThreshold, memoryWatermark;
+    const unsigned short logPriority;
+    const bool isCapturing;
+    const std::array<unsigned int, taskClassCount> budgets;
+    const std::shared_ptr<WorkerPool> workerPool;
     const std::shared_ptr<Ring> ring;
     const std::shared_ptr<Logger> logger{std::make_shared<Logger>(0)};
-    const Server server{1};
-    Timer timer{2};
+    const std::vector<Server> servers;
+    Timer timer{1};
+    Recorder recorder{2};
+    const std::unique_ptr<TlsContext> tlsContext;
     HttpParse httpParse{this->logger};
     std::unordered_map<int, Client> clients;
+    std::unordered_map<int, unsigned int> migrations;
+    std::unordered_map<int, Http2Session> sessions;
+    std::unordered_map<int, WebSocket> webSockets;
+    std::unordered_set<int> handshakes;
+    std::vector<int> notifiers;
+    Shedder shedder;
+    LatencyTable latencies;
+    unsigned long tickCount{}, sendingBytes{};
+    std::unordered_set<int> acceptingServers;
+    bool isAcceptPaused{};
     RingBuffer ringBuffer{this->ring, entries, 0};
     BufferGroup bufferGroup{entries};
     std::unordered_map<unsigned long, std::shared_ptr<Task>> tasks;
+    std::vector<unsigned long> finishedTasks;
+    std::deque<Completion> deferredCompletions;
     unsigned long currentUserData{};
 };
@@ -0,0 +1,39 @@
+#include "Shedder.hpp"
+
+#include <algorithm>
+
+Shedder::Shedder(const unsigned long taskLimit, const unsigned long logLimit,
+                 const std::chrono::milliseconds latencyLimit) noexcept :
+    taskLimit{taskLimit}, logLimit{logLimit}, latencyLimit{latencyLimit} {}
+
+auto Shedder::addLatency(const std::chrono::steady_clock::duration latency) noexcept -> void {
+    this->latency = std::max(this->latency, latency);
+}
+
+auto Shedder::update(const unsigned long taskCount, const unsigned long logCount) noexcept -> void {
+    const bool isOverloaded{(this->taskLimit != 0 && taskCount > this->taskLimit) ||
+                            (this->logLimit != 0 && logCount > this->logLimit) ||
+                            (this->latencyLimit != std::chrono::steady_clock::duration{} &&
+                             this->latency > this->latencyLimit)};
+    this->latency = {};
+
+    // halved while overloaded and recovered step by step, the floor keeps a steady fraction of requests served
+    this->admission =
+        isOverloaded ? std::max(this->admission / 2, scale / 16) : std::min(this->admission + scale / 16, scale);
+}
+
+auto Shedder::isShedding() noexcept -> bool {
+    if (this->admission == scale) [[likely]] return false;
+
+    // admitted requests are spread evenly instead of in bursts
+    this->credit += this->admission;
+    if (this->credit >= scale) {
+        this->credit -= scale;
+
+        return false;
+    }
+
+    return true;
+}
+
+auto Shedder::getAdmission() const noexcept -> unsigned int { return this->admission; }
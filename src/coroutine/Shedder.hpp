@@ -0,0 +1,23 @@
+#pragma once
+
+#include <chrono>
+
+class Shedder {
+public:
+    static constexpr unsigned int scale{1024};
+
+    Shedder(unsigned long taskLimit, unsigned long logLimit, std::chrono::milliseconds latencyLimit) noexcept;
+
+    auto addLatency(std::chrono::steady_clock::duration latency) noexcept -> void;
+
+    auto update(unsigned long taskCount, unsigned long logCount) noexcept -> void;
+
+    [[nodiscard]] auto isShedding() noexcept -> bool;
+
+    [[nodiscard]] auto getAdmission() const noexcept -> unsigned int;
+
+private:
+    unsigned long taskLimit, logLimit;
+    std::chrono::steady_clock::duration latencyLimit, latency{};
+    unsigned int admission{scale}, credit{};
+};
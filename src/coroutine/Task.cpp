@@ -1,21 +1,60 @@
 #include "Task.hpp"
 
+#include <linux/io_uring.h>
 #include <utility>
 
 auto Task::promise_type::get_return_object() -> Task {
-    return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    const auto handle{std::coroutine_handle<promise_type>::from_promise(*this)};
+    this->currentHandle = handle;
+
+    return Task{handle};
 }
 
 auto Task::promise_type::unhandled_exception() const -> void { throw; }
 
-auto Task::promise_type::setSubmission(const Submission &submission) noexcept -> void { this->submission = submission; }
+auto Task::promise_type::setSubmission(const Submission &submission) noexcept -> void {
+    // a multishot request that is still armed keeps delivering completions, awaiting it again submits nothing
+    const auto type{static_cast<Submission::Type>(submission.parameter.index())};
+    this->isPending = !((type == Submission::Type::accept || type == Submission::Type::receive) &&
+                        type == static_cast<Submission::Type>(this->submission.parameter.index()) &&
+                        submission.fileDescriptor == this->submission.fileDescriptor &&
+                        (this->outcome.flags & IORING_CQE_F_MORE) != 0);
+
+    this->submission = submission;
+}
 
 auto Task::promise_type::getSubmission() const noexcept -> const Submission & { return this->submission; }
 
+auto Task::promise_type::isSubmissionPending() const noexcept -> bool { return this->isPending; }
+
+auto Task::promise_type::takeSubmission() noexcept -> const Submission & {
+    this->isPending = false;
+
+    return this->submission;
+}
+
 auto Task::promise_type::setOutcome(const Outcome outcome) noexcept -> void { this->outcome = outcome; }
 
 auto Task::promise_type::getOutcome() const noexcept -> Outcome { return this->outcome; }
 
+auto Task::promise_type::setCurrentHandle(const std::coroutine_handle<> handle) noexcept -> void {
+    this->currentHandle = handle;
+}
+
+auto Task::promise_type::getCurrentHandle() const noexcept -> std::coroutine_handle<> { return this->currentHandle; }
+
+auto Task::promise_type::resume(const Outcome outcome) -> void {
+    this->outcome = outcome;
+
+    // the innermost nested coroutine is the one waiting for this outcome
+    this->currentHandle.resume();
+}
+
+auto Task::getPromise(const unsigned long userData) noexcept -> promise_type & {
+    // the user data of a request is the address of the task frame awaiting it
+    return std::coroutine_handle<promise_type>::from_address(reinterpret_cast<void *>(userData)).promise();
+}
+
 Task::Task(const std::coroutine_handle<promise_type> handle) noexcept : handle{handle} {}
 
 Task::Task(Task &&other) noexcept : handle{std::exchange(other.handle, nullptr)} {}
@@ -34,10 +73,11 @@ Task::~Task() { this->destroy(); }
 
 auto Task::getSubmission() const -> const Submission & { return this->handle.promise().getSubmission(); }
 
-auto Task::resume(const Outcome outcome) const -> void {
-    this->handle.promise().setOutcome(outcome);
-    this->handle.resume();
-}
+auto Task::isSubmissionPending() const -> bool { return this->handle.promise().isSubmissionPending(); }
+
+auto Task::takeSubmission() const -> const Submission & { return this->handle.promise().takeSubmission(); }
+
+auto Task::resume(const Outcome outcome) const -> void { this->handle.promise().resume(outcome); }
 
 auto Task::destroy() const -> void {
     if (this->handle) this->handle.destroy();
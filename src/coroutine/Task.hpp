@@ -15,21 +15,37 @@ public:
 
         [[nodiscard]] constexpr auto final_suspend() const noexcept { return std::suspend_always{}; }
 
+        constexpr auto return_void() const noexcept -> void {}
+
         auto unhandled_exception() const -> void;
 
         auto setSubmission(const Submission &submission) noexcept -> void;
 
         [[nodiscard]] auto getSubmission() const noexcept -> const Submission &;
 
+        [[nodiscard]] auto isSubmissionPending() const noexcept -> bool;
+
+        [[nodiscard]] auto takeSubmission() noexcept -> const Submission &;
+
         auto setOutcome(Outcome outcome) noexcept -> void;
 
         [[nodiscard]] auto getOutcome() const noexcept -> Outcome;
 
+        auto setCurrentHandle(std::coroutine_handle<> handle) noexcept -> void;
+
+        [[nodiscard]] auto getCurrentHandle() const noexcept -> std::coroutine_handle<>;
+
+        auto resume(Outcome outcome) -> void;
+
     private:
         Submission submission;
         Outcome outcome;
+        std::coroutine_handle<> currentHandle;
+        bool isPending{};
     };
 
+    [[nodiscard]] static auto getPromise(unsigned long userData) noexcept -> promise_type &;
+
     explicit Task(std::coroutine_handle<promise_type> handle) noexcept;
 
     Task(const Task &) = delete;
@@ -44,6 +60,10 @@ public:
 
     [[nodiscard]] auto getSubmission() const -> const Submission &;
 
+    [[nodiscard]] auto isSubmissionPending() const -> bool;
+
+    [[nodiscard]] auto takeSubmission() const -> const Submission &;
+
     auto resume(Outcome outcome) const -> void;
 
 private:
@@ -0,0 +1,57 @@
+#include "WorkerPool.hpp"
+
+WorkerPool::WorkerPool(const unsigned int count) : queues(count) {
+    for (unsigned int i{}; i != count; ++i) {
+        this->workers.emplace_back([this, i](const std::stop_token stopToken) { this->run(stopToken, i); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    for (auto &worker : this->workers) worker.request_stop();
+    this->semaphore.release(static_cast<long>(this->workers.size()));
+}
+
+auto WorkerPool::getWorkerCount() const noexcept -> unsigned long { return this->workers.size(); }
+
+auto WorkerPool::push(std::move_only_function<auto()->void> &&work) -> void {
+    Queue &queue{this->queues[this->next.fetch_add(1, std::memory_order::relaxed) % this->queues.size()]};
+    {
+        const std::lock_guard lockGuard{queue.lock};
+        queue.works.emplace_back(std::move(work));
+    }
+
+    this->semaphore.release();
+}
+
+auto WorkerPool::run(const std::stop_token stopToken, const unsigned int index) -> void {
+    while (true) {
+        this->semaphore.acquire();
+        if (stopToken.stop_requested()) break;
+
+        if (auto work{this->pop(index)}) work();
+    }
+}
+
+auto WorkerPool::pop(const unsigned int index) -> std::move_only_function<auto()->void> {
+    // every acquired count stands for one queued work, so some queue holds it even if it is not the worker's own
+    for (unsigned long i{}; i != this->queues.size(); ++i) {
+        Queue &queue{this->queues[(index + i) % this->queues.size()]};
+
+        const std::lock_guard lockGuard{queue.lock};
+        if (queue.works.empty()) continue;
+
+        // the owner takes the oldest work, thieves take the newest from the other end
+        std::move_only_function<auto()->void> work;
+        if (i == 0) {
+            work = std::move(queue.works.front());
+            queue.works.pop_front();
+        } else {
+            work = std::move(queue.works.back());
+            queue.works.pop_back();
+        }
+
+        return work;
+    }
+
+    return {};
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+class WorkerPool {
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::move_only_function<auto()->void>> works;
+    };
+
+public:
+    explicit WorkerPool(unsigned int count);
+
+    WorkerPool(const WorkerPool &) = delete;
+
+    WorkerPool(WorkerPool &&) noexcept = delete;
+
+    auto operator=(const WorkerPool &) -> WorkerPool & = delete;
+
+    auto operator=(WorkerPool &&) noexcept -> WorkerPool & = delete;
+
+    ~WorkerPool();
+
+    [[nodiscard]] auto getWorkerCount() const noexcept -> unsigned long;
+
+    auto push(std::move_only_function<auto()->void> &&work) -> void;
+
+private:
+    auto run(std::stop_token stopToken, unsigned int index) -> void;
+
+    [[nodiscard]] auto pop(unsigned int index) -> std::move_only_function<auto()->void>;
+
+    std::vector<Queue> queues;
+    std::counting_semaphore<> semaphore{0};
+    std::atomic_uint next;
+    std::vector<std::jthread> workers;
+};
@@ -1,9 +1,10 @@
 #include "Client.hpp"
 
 #include <linux/io_uring.h>
+#include <utility>
 
-Client::Client(const int fileDescriptor, const std::chrono::seconds seconds) noexcept :
-    FileDescriptor{fileDescriptor}, seconds{seconds} {}
+Client::Client(const int fileDescriptor, const std::chrono::seconds seconds, const bool isZeroCopyEnabled) noexcept :
+    FileDescriptor{fileDescriptor}, seconds{seconds}, isZeroCopyEnabled{isZeroCopyEnabled} {}
 
 auto Client::getSeconds() const noexcept -> std::chrono::seconds { return this->seconds; }
 
@@ -23,7 +24,44 @@ auto Client::send(const std::span<const std::byte> data) const noexcept -> Await
         Submission{
                    this->getFileDescriptor(),
                    IOSQE_FIXED_FILE, 0,
-                   0, Submission::Send{data, 0, 0},
+                   0, Submission::Send{data, 0, 0, !this->isZeroCopyEnabled},
                    }
     };
 }
+
+auto Client::read(const std::span<std::byte> buffer) const noexcept -> Awaiter {
+    return Awaiter{
+        Submission{this->getFileDescriptor(), IOSQE_FIXED_FILE, 0, 0, Submission::Read{buffer, 0}}
+    };
+}
+
+auto Client::setOption(const int level, const int name, const std::span<const std::byte> value) const noexcept
+    -> Awaiter {
+    return Awaiter{
+        Submission{this->getFileDescriptor(), IOSQE_FIXED_FILE, 0, 0, Submission::SocketOption{level, name, value}}
+    };
+}
+
+auto Client::migrate(const int ringFileDescriptor, const unsigned long userData) const noexcept -> Awaiter {
+    return Awaiter{
+        Submission{ringFileDescriptor, 0, 0, 0, Submission::Message{this->getFileDescriptor(), userData}}
+    };
+}
+
+auto Client::addTraffic(const unsigned long size) noexcept -> void { this->traffic += size; }
+
+auto Client::exchangeTraffic() noexcept -> unsigned long { return std::exchange(this->traffic, 0); }
+
+auto Client::startSending() noexcept -> void { ++this->sendingCount; }
+
+auto Client::finishSending() noexcept -> void { --this->sendingCount; }
+
+auto Client::isSending() const noexcept -> bool { return this->sendingCount != 0; }
+
+auto Client::startOffloading() noexcept -> void { ++this->offloadingCount; }
+
+auto Client::finishOffloading() noexcept -> void { --this->offloadingCount; }
+
+auto Client::isOffloading() const noexcept -> bool { return this->offloadingCount != 0; }
+
+auto Client::isZeroCopy() const noexcept -> bool { return this->isZeroCopyEnabled; }
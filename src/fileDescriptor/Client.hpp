@@ -6,7 +6,7 @@
 
 class Client final : public FileDescriptor {
 public:
-    Client(int fileDescriptor, std::chrono::seconds seconds) noexcept;
+    Client(int fileDescriptor, std::chrono::seconds seconds, bool isZeroCopyEnabled) noexcept;
 
     Client(const Client &) = delete;
 
@@ -24,6 +24,33 @@ public:
 
     [[nodiscard]] auto send(std::span<const std::byte> data) const noexcept -> Awaiter;
 
+    [[nodiscard]] auto read(std::span<std::byte> buffer) const noexcept -> Awaiter;
+
+    [[nodiscard]] auto setOption(int level, int name, std::span<const std::byte> value) const noexcept -> Awaiter;
+
+    [[nodiscard]] auto migrate(int ringFileDescriptor, unsigned long userData) const noexcept -> Awaiter;
+
+    auto addTraffic(unsigned long size) noexcept -> void;
+
+    [[nodiscard]] auto exchangeTraffic() noexcept -> unsigned long;
+
+    auto startSending() noexcept -> void;
+
+    auto finishSending() noexcept -> void;
+
+    [[nodiscard]] auto isSending() const noexcept -> bool;
+
+    auto startOffloading() noexcept -> void;
+
+    auto finishOffloading() noexcept -> void;
+
+    [[nodiscard]] auto isOffloading() const noexcept -> bool;
+
+    [[nodiscard]] auto isZeroCopy() const noexcept -> bool;
+
 private:
     std::chrono::seconds seconds;
+    unsigned long traffic{};
+    unsigned int sendingCount{}, offloadingCount{};
+    bool isZeroCopyEnabled;
 };
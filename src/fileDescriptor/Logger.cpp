@@ -4,6 +4,7 @@
 
 #include <fcntl.h>
 #include <linux/io_uring.h>
+#include <utility>
 
 auto Logger::create(const std::string_view filename, const std::source_location sourceLocation) -> int {
     const int fileDescriptor{open(filename.data(), O_CREAT | O_WRONLY | O_APPEND, S_IRUSR | S_IWUSR)};
@@ -20,9 +21,13 @@ Logger::Logger(const int fileDescriptor) noexcept : FileDescriptor{fileDescripto
 
 auto Logger::push(Log &&log) -> void { this->logs.emplace_back(std::move(log)); }
 
+auto Logger::takeLogs() noexcept -> std::vector<Log> { return std::exchange(this->logs, {}); }
+
 auto Logger::isWritable() const noexcept -> bool { return !this->logs.empty() && this->buffer.empty(); }
 
-auto Logger::write() -> Awaiter {
+auto Logger::getBacklog() const noexcept -> unsigned long { return this->logs.size(); }
+
+auto Logger::write(const unsigned short ioPriority) -> Awaiter {
     for (const auto &log : this->logs) {
         const std::vector bytes{log.toByte()};
         this->buffer.insert(this->buffer.cend(), bytes.cbegin(), bytes.cend());
@@ -30,7 +35,7 @@ auto Logger::write() -> Awaiter {
     this->logs.clear();
 
     return Awaiter{
-        Submission{this->getFileDescriptor(), IOSQE_FIXED_FILE, 0, 0, Submission::Write{this->buffer, 0}}
+        Submission{this->getFileDescriptor(), IOSQE_FIXED_FILE, ioPriority, 0, Submission::Write{this->buffer, 0}}
     };
 }
 
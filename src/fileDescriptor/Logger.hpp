@@ -22,9 +22,13 @@ public:
 
     auto push(Log &&log) -> void;
 
+    [[nodiscard]] auto takeLogs() noexcept -> std::vector<Log>;
+
     [[nodiscard]] auto isWritable() const noexcept -> bool;
 
-    [[nodiscard]] auto write() -> Awaiter;
+    [[nodiscard]] auto getBacklog() const noexcept -> unsigned long;
+
+    [[nodiscard]] auto write(unsigned short ioPriority) -> Awaiter;
 
     auto wrote() noexcept -> void;
 
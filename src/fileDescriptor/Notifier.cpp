@@ -0,0 +1,30 @@
+#include "Notifier.hpp"
+
+#include "../log/Exception.hpp"
+
+#include <sys/eventfd.h>
+
+auto Notifier::create(const std::source_location sourceLocation) -> int {
+    const int fileDescriptor{eventfd(0, EFD_CLOEXEC)};
+    if (fileDescriptor == -1) {
+        throw Exception{
+            Log{Log::Level::error, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
+        };
+    }
+
+    return fileDescriptor;
+}
+
+auto Notifier::notify(const int fileDescriptor) noexcept -> void { eventfd_write(fileDescriptor, 1); }
+
+Notifier::Notifier(const int fileDescriptor) noexcept : FileDescriptor{fileDescriptor} {}
+
+auto Notifier::wait() noexcept -> Awaiter {
+    return Awaiter{
+        Submission{
+                   this->getFileDescriptor(),
+                   0, 0,
+                   0, Submission::Read{std::as_writable_bytes(std::span{&this->count, 1}), 0},
+                   }
+    };
+}
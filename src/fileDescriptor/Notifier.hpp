@@ -0,0 +1,29 @@
+#pragma once
+
+#include "FileDescriptor.hpp"
+
+#include <source_location>
+
+class Notifier final : public FileDescriptor {
+public:
+    [[nodiscard]] static auto create(std::source_location sourceLocation = std::source_location::current()) -> int;
+
+    static auto notify(int fileDescriptor) noexcept -> void;
+
+    explicit Notifier(int fileDescriptor) noexcept;
+
+    Notifier(const Notifier &) = delete;
+
+    Notifier(Notifier &&) noexcept = default;
+
+    auto operator=(const Notifier &) -> Notifier & = delete;
+
+    auto operator=(Notifier &&) noexcept -> Notifier & = delete;
+
+    ~Notifier() override = default;
+
+    [[nodiscard]] auto wait() noexcept -> Awaiter;
+
+private:
+    unsigned long count{};
+};
@@ -0,0 +1,47 @@
+#include "Recorder.hpp"
+
+#include "../log/Exception.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <unistd.h>
+
+auto Recorder::create(const std::string_view filename, const std::source_location sourceLocation) -> int {
+    const int fileDescriptor{open(filename.data(), O_CREAT | O_WRONLY | O_TRUNC | O_APPEND, S_IRUSR | S_IWUSR)};
+    if (fileDescriptor == -1 || ::write(fileDescriptor, signature.data(), signature.size()) !=
+                                    static_cast<long>(signature.size())) {
+        throw Exception{
+            Log{Log::Level::fatal, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
+        };
+    }
+
+    return fileDescriptor;
+}
+
+Recorder::Recorder(const int fileDescriptor) noexcept : FileDescriptor{fileDescriptor} {}
+
+auto Recorder::record(const int connection, const std::span<const std::byte> data,
+                      const std::chrono::steady_clock::time_point time) -> void {
+    // times are monotonic clock readings, so captures of different schedulers interleave correctly on replay
+    const Record record{static_cast<unsigned long>(std::chrono::nanoseconds{time.time_since_epoch()}.count()),
+                        static_cast<unsigned int>(connection), static_cast<unsigned int>(data.size())};
+
+    const unsigned long offset{this->records.size()};
+    this->records.resize(offset + sizeof(record) + data.size());
+    std::memcpy(this->records.data() + offset, &record, sizeof(record));
+    std::memcpy(this->records.data() + offset + sizeof(record), data.data(), data.size());
+}
+
+auto Recorder::isWritable() const noexcept -> bool { return !this->records.empty() && this->buffer.empty(); }
+
+auto Recorder::write() -> Awaiter {
+    // records keep accumulating in the other buffer while this one is written
+    std::swap(this->records, this->buffer);
+
+    return Awaiter{
+        Submission{this->getFileDescriptor(), IOSQE_FIXED_FILE, 0, 0, Submission::Write{this->buffer, 0}}
+    };
+}
+
+auto Recorder::wrote() noexcept -> void { this->buffer.clear(); }
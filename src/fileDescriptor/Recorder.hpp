@@ -0,0 +1,47 @@
+#pragma once
+
+#include "FileDescriptor.hpp"
+
+#include <chrono>
+#include <source_location>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// captures received bytes as a signature followed by records, each a Record header and then its data
+class Recorder final : public FileDescriptor {
+public:
+    struct Record {
+        unsigned long time;
+        unsigned int connection, size;
+    };
+
+    static constexpr std::string_view signature{"wscap001"};
+
+    [[nodiscard]] static auto create(std::string_view filename,
+                                     std::source_location sourceLocation = std::source_location::current()) -> int;
+
+    explicit Recorder(int fileDescriptor) noexcept;
+
+    Recorder(const Recorder &) = delete;
+
+    Recorder(Recorder &&) noexcept = default;
+
+    auto operator=(const Recorder &) -> Recorder & = delete;
+
+    auto operator=(Recorder &&) noexcept -> Recorder & = delete;
+
+    ~Recorder() override = default;
+
+    auto record(int connection, std::span<const std::byte> data,
+                std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now()) -> void;
+
+    [[nodiscard]] auto isWritable() const noexcept -> bool;
+
+    [[nodiscard]] auto write() -> Awaiter;
+
+    auto wrote() noexcept -> void;
+
+private:
+    std::vector<std::byte> records, buffer;
+};
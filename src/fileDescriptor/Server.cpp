@@ -3,11 +3,16 @@
 #include "../log/Exception.hpp"
 
 #include <arpa/inet.h>
+#include <charconv>
+#include <linux/filter.h>
 #include <linux/io_uring.h>
+#include <sys/un.h>
+#include <unistd.h>
 
-[[nodiscard]] constexpr auto socket(const std::source_location sourceLocation = std::source_location::current())
+[[nodiscard]] constexpr auto socket(const int domain,
+                                    const std::source_location sourceLocation = std::source_location::current())
     -> int {
-    const int fileDescriptor{socket(AF_INET, SOCK_STREAM, 0)};
+    const int fileDescriptor{socket(domain, SOCK_STREAM, 0)};
     if (fileDescriptor == -1) {
         throw Exception{
             Log{Log::Level::fatal, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
@@ -17,26 +22,58 @@
     return fileDescriptor;
 }
 
-constexpr auto setSocketOption(const int fileDescriptor,
+constexpr auto setSocketOption(const int fileDescriptor, const int level, const int name,
                                const std::source_location sourceLocation = std::source_location::current()) -> void {
     constexpr auto option{1};
-    if (setsockopt(fileDescriptor, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &option, sizeof(option)) == -1) {
+    if (setsockopt(fileDescriptor, level, name, &option, sizeof(option)) == -1) {
         throw Exception{
             Log{Log::Level::fatal, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
         };
     }
 }
 
-constexpr auto translateIpAddress(const std::string_view host, in_addr &address,
-                                  const std::source_location sourceLocation = std::source_location::current()) -> void {
-    if (inet_pton(AF_INET, host.data(), &address) != 1) {
+constexpr auto attachCpuFilter(const int fileDescriptor,
+                               const std::source_location sourceLocation = std::source_location::current()) -> void {
+    // listeners join the reuseport group in cpu order, so returning the receiving cpu picks the listener of the
+    // scheduler pinned to that cpu
+    std::array code{
+        sock_filter{BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<unsigned int>(SKF_AD_OFF + SKF_AD_CPU)},
+        sock_filter{BPF_RET | BPF_A, 0, 0, 0}
+    };
+    const sock_fprog program{code.size(), code.data()};
+
+    if (setsockopt(fileDescriptor, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) == -1) {
         throw Exception{
             Log{Log::Level::fatal, std::error_code{errno, std::generic_category()}.message(), sourceLocation}
         };
     }
 }
 
-constexpr auto bind(const int fileDescriptor, const sockaddr_in &address,
+constexpr auto translateIpAddress(const int family, const std::string &host, void *const address,
+                                  const std::source_location sourceLocation = std::source_location::current()) -> void {
+    if (inet_pton(family, host.c_str(), address) != 1) {
+        throw Exception{
+            Log{Log::Level::fatal, "invalid listen address: " + host, sourceLocation}
+        };
+    }
+}
+
+[[nodiscard]] constexpr auto translatePort(const std::string_view port,
+                                           const std::source_location sourceLocation = std::source_location::current())
+    -> unsigned short {
+    unsigned short number;
+    if (const auto [point, error]{std::from_chars(port.cbegin(), port.cend(), number)};
+        error != std::errc{} || point != port.cend()) {
+        throw Exception{
+            Log{Log::Level::fatal, std::format("invalid listen port: {}", port), sourceLocation}
+        };
+    }
+
+    return htons(number);
+}
+
+template<typename T>
+constexpr auto bind(const int fileDescriptor, const T &address,
                     const std::source_location sourceLocation = std::source_location::current()) -> void {
     if (bind(fileDescriptor, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == -1) {
         throw Exception{
@@ -54,26 +91,84 @@ constexpr auto listen(const int fileDescriptor,
     }
 }
 
-auto Server::create(const std::string_view host, const unsigned short port) -> int {
-    const int fileDescriptor{socket()};
+auto Server::create(const std::string_view address, const std::source_location sourceLocation) -> int {
+    if (isUnixAddress(address)) {
+        const std::string path{address.substr(5)};
 
-    setSocketOption(fileDescriptor);
+        sockaddr_un socketAddress{};
+        socketAddress.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(socketAddress.sun_path)) {
+            throw Exception{
+                Log{Log::Level::fatal, std::format("invalid listen address: {}", address), sourceLocation}
+            };
+        }
+        path.copy(socketAddress.sun_path, path.size());
 
-    sockaddr_in address{};
-    address.sin_family = AF_INET;
-    address.sin_port = htons(port);
-    translateIpAddress(host, address.sin_addr);
+        // unix sockets have no reuseport group, one listener is shared by all schedulers, and the file left behind
+        // by an earlier run would fail the bind
+        const int fileDescriptor{socket(AF_UNIX)};
+        unlink(path.c_str());
+        bind(fileDescriptor, socketAddress);
+        listen(fileDescriptor);
 
-    bind(fileDescriptor, address);
+        return fileDescriptor;
+    }
+
+    const unsigned long splitPoint{address.rfind(':')};
+    if (splitPoint == std::string_view::npos) {
+        throw Exception{
+            Log{Log::Level::fatal, std::format("invalid listen address: {}", address), sourceLocation}
+        };
+    }
+    const std::string_view host{address.substr(0, splitPoint)};
+    const unsigned short port{translatePort(address.substr(splitPoint + 1))};
+
+    if (host.starts_with('[') && host.ends_with(']')) {
+        const int fileDescriptor{socket(AF_INET6)};
+
+        // the same port can then be bound for ipv4 by another listener
+        setSocketOption(fileDescriptor, IPPROTO_IPV6, IPV6_V6ONLY);
+        setSocketOption(fileDescriptor, SOL_SOCKET, SO_REUSEADDR);
+        setSocketOption(fileDescriptor, SOL_SOCKET, SO_REUSEPORT);
+        attachCpuFilter(fileDescriptor);
+
+        sockaddr_in6 socketAddress{};
+        socketAddress.sin6_family = AF_INET6;
+        socketAddress.sin6_port = port;
+        translateIpAddress(AF_INET6, std::string{host.substr(1, host.size() - 2)}, &socketAddress.sin6_addr);
+
+        bind(fileDescriptor, socketAddress);
+        listen(fileDescriptor);
+
+        return fileDescriptor;
+    }
+
+    const int fileDescriptor{socket(AF_INET)};
+
+    setSocketOption(fileDescriptor, SOL_SOCKET, SO_REUSEADDR);
+    setSocketOption(fileDescriptor, SOL_SOCKET, SO_REUSEPORT);
+    attachCpuFilter(fileDescriptor);
+
+    sockaddr_in socketAddress{};
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = port;
+    translateIpAddress(AF_INET, std::string{host}, &socketAddress.sin_addr);
+
+    bind(fileDescriptor, socketAddress);
     listen(fileDescriptor);
 
     return fileDescriptor;
 }
 
-Server::Server(const int fileDescriptor) noexcept : FileDescriptor{fileDescriptor} {}
+auto Server::isUnixAddress(const std::string_view address) noexcept -> bool { return address.starts_with("unix:"); }
+
+Server::Server(const int fileDescriptor, const bool isUnixDomain) noexcept :
+    FileDescriptor{fileDescriptor}, isUnixDomain{isUnixDomain} {}
 
 auto Server::accept() const noexcept -> Awaiter {
     return Awaiter{
         Submission{this->getFileDescriptor(), IOSQE_FIXED_FILE, IORING_ACCEPT_POLL_FIRST, 0, Submission::Accept{}}
     };
 }
+
+auto Server::isUnix() const noexcept -> bool { return this->isUnixDomain; }
@@ -2,13 +2,18 @@
 
 #include "FileDescriptor.hpp"
 
+#include <source_location>
 #include <string_view>
 
 class Server final : public FileDescriptor {
 public:
-    [[nodiscard]] static auto create(std::string_view host, unsigned short port) -> int;
+    // an address is host:port, [host]:port for ipv6 or unix:path
+    [[nodiscard]] static auto create(std::string_view address,
+                                     std::source_location sourceLocation = std::source_location::current()) -> int;
 
-    explicit Server(int fileDescriptor) noexcept;
+    [[nodiscard]] static auto isUnixAddress(std::string_view address) noexcept -> bool;
+
+    Server(int fileDescriptor, bool isUnixDomain) noexcept;
 
     Server(const Server &) = delete;
 
@@ -21,4 +26,10 @@ public:
     constexpr ~Server() override = default;
 
     [[nodiscard]] auto accept() const noexcept -> Awaiter;
+
+    // unix sockets support neither zero copy sends nor kernel tls
+    [[nodiscard]] auto isUnix() const noexcept -> bool;
+
+private:
+    bool isUnixDomain;
 };
@@ -4,6 +4,7 @@
 
 #include <linux/io_uring.h>
 #include <sys/timerfd.h>
+#include <utility>
 
 [[nodiscard]] constexpr auto
     createTimerFileDescriptor(const std::source_location sourceLocation = std::source_location::current()) -> int {
@@ -72,10 +73,12 @@ auto Timer::remove(const int fileDescriptor) -> void {
     }
 }
 
-auto Timer::clearTimeout() -> std::vector<int> {
+auto Timer::clearTimeout() -> std::vector<int> { return this->expire(std::exchange(this->timeout, 0)); }
+
+auto Timer::expire(unsigned long tickCount) -> std::vector<int> {
     std::vector<int> result;
 
-    while (this->timeout > 0) {
+    while (tickCount > 0) {
         std::unordered_map<int, unsigned long> &wheelPoint{this->wheel[this->now.count()]};
         for (auto element{wheelPoint.begin()}; element != wheelPoint.end();) {
             if (element->second == 0) {
@@ -91,7 +94,7 @@ auto Timer::clearTimeout() -> std::vector<int> {
 
         ++this->now;
         this->now %= static_cast<decltype(this->now)>(this->wheel.size());
-        --this->timeout;
+        --tickCount;
     }
 
     return result;
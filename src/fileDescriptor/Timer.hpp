@@ -2,8 +2,10 @@
 
 #include "FileDescriptor.hpp"
 
+#include <array>
 #include <chrono>
 #include <unordered_map>
+#include <vector>
 
 class Timer final : public FileDescriptor {
 public:
@@ -31,6 +33,8 @@ public:
 
     [[nodiscard]] auto clearTimeout() -> std::vector<int>;
 
+    [[nodiscard]] auto expire(unsigned long tickCount) -> std::vector<int>;
+
 private:
     unsigned long timeout{};
     std::chrono::seconds now{};
@@ -0,0 +1,203 @@
+#include "Compressor.hpp"
+
+#include "../log/Exception.hpp"
+
+#include <algorithm>
+#include <array>
+#include <brotli/encode.h>
+#include <cctype>
+#include <charconv>
+#include <utility>
+
+[[nodiscard]] static auto trim(std::string_view value) noexcept -> std::string_view {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+
+    return value;
+}
+
+[[nodiscard]] static auto isEqual(const std::string_view value, const std::string_view token) noexcept -> bool {
+    return std::ranges::equal(value, token, [](const char left, const char right) {
+        return std::tolower(static_cast<unsigned char>(left)) == right;
+    });
+}
+
+// the q-value in thousandths, or -1 when it is malformed
+[[nodiscard]] static auto parseWeight(std::string_view parameters) noexcept -> int {
+    for (unsigned long start{}; start < parameters.size();) {
+        const unsigned long end{std::min(parameters.find(';', start), parameters.size())};
+        const std::string_view parameter{trim(parameters.substr(start, end - start))};
+        start = end + 1;
+
+        if (parameter.size() < 2 || !isEqual(parameter.substr(0, 2), "q=")) continue;
+
+        double weight;
+        const std::string_view value{parameter.substr(2)};
+        if (const auto [point, error]{std::from_chars(value.data(), value.data() + value.size(), weight)};
+            error != std::errc{} || point != value.data() + value.size() || weight < 0 || weight > 1)
+            return -1;
+
+        return static_cast<int>(weight * 1000 + 0.5);
+    }
+
+    return 1000;
+}
+
+auto Compressor::Deleter::operator()(z_stream *const stream) const noexcept -> void {
+    deflateEnd(stream);
+    delete stream;
+}
+
+auto Compressor::Deleter::operator()(ZSTD_CCtx *const context) const noexcept -> void { ZSTD_freeCCtx(context); }
+
+auto Compressor::negotiate(const std::string_view acceptEncoding) -> Coding {
+    static constexpr std::array names{"br", "zstd", "gzip", "identity"};
+
+    // -1 marks a coding the client did not name
+    std::array<int, names.size()> weights;
+    weights.fill(-1);
+    int wildcardWeight{-1};
+
+    for (unsigned long start{}; start < acceptEncoding.size();) {
+        const unsigned long end{std::min(acceptEncoding.find(',', start), acceptEncoding.size())};
+        const std::string_view element{trim(acceptEncoding.substr(start, end - start))};
+        start = end + 1;
+
+        const unsigned long splitPoint{std::min(element.find(';'), element.size())};
+        const std::string_view name{trim(element.substr(0, splitPoint))};
+        const int weight{parseWeight(element.substr(splitPoint))};
+        if (name.empty() || weight == -1) continue;
+
+        if (name == "*") wildcardWeight = weight;
+        else if (isEqual(name, "x-gzip")) weights[std::to_underlying(Coding::gzip)] = weight;
+        else if (const auto point{std::ranges::find_if(names, [name](const std::string_view coding) {
+                     return isEqual(name, coding);
+                 })};
+                 point != names.cend())
+            weights[point - names.cbegin()] = weight;
+    }
+
+    // identity stays acceptable unless it is excluded by name or by the wildcard, but never beats a named coding
+    int &identityWeight{weights[std::to_underlying(Coding::identity)]};
+    if (identityWeight == -1) identityWeight = wildcardWeight == 0 ? 0 : 1;
+    for (int &weight : weights) {
+        if (weight == -1) weight = wildcardWeight;
+    }
+
+    // a client that refuses everything still gets identity rather than a 406
+    const auto point{std::ranges::max_element(weights)};
+
+    return *point > 0 ? static_cast<Coding>(point - weights.cbegin()) : Coding::identity;
+}
+
+auto Compressor::getName(const Coding coding) noexcept -> std::string_view {
+    switch (coding) {
+        case Coding::brotli:
+            return "br";
+        case Coding::zstd:
+            return "zstd";
+        case Coding::gzip:
+            return "gzip";
+        default:
+            return "identity";
+    }
+}
+
+Compressor::Compressor(const std::source_location sourceLocation) :
+    gzipStreams{std::unique_ptr<z_stream, Deleter>{new z_stream{}},
+                std::unique_ptr<z_stream, Deleter>{new z_stream{}}},
+    zstdContext{ZSTD_createCCtx()} {
+    // 16 added to the window bits asks for the gzip wrapper instead of the zlib one
+    if (deflateInit2(this->gzipStreams[std::to_underlying(Level::fast)].get(), Z_BEST_SPEED, Z_DEFLATED,
+                     MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK ||
+        deflateInit2(this->gzipStreams[std::to_underlying(Level::best)].get(), Z_BEST_COMPRESSION, Z_DEFLATED,
+                     MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw Exception{
+            Log{Log::Level::fatal, "gzip initialization failed", sourceLocation}
+        };
+    }
+    if (this->zstdContext == nullptr) {
+        throw Exception{
+            Log{Log::Level::fatal, "zstd initialization failed", sourceLocation}
+        };
+    }
+}
+
+auto Compressor::compress(const std::span<const std::byte> data, const Coding coding, const Level level,
+                          const std::source_location sourceLocation) -> std::vector<std::byte> {
+    switch (coding) {
+        case Coding::brotli:
+            return brotli(data, level, sourceLocation);
+        case Coding::zstd:
+            return this->zstd(data, level, sourceLocation);
+        case Coding::gzip:
+            return this->gzip(data, level, sourceLocation);
+        default:
+            return std::vector<std::byte>{data.cbegin(), data.cend()};
+    }
+}
+
+auto Compressor::brotli(const std::span<const std::byte> data, const Level level,
+                        const std::source_location sourceLocation) -> std::vector<std::byte> {
+    unsigned long encodedSize{BrotliEncoderMaxCompressedSize(data.size())};
+    std::vector<std::byte> encodedData{encodedSize};
+
+    // an encoder instance cannot be reset, so brotli keeps the one-shot call
+    if (BrotliEncoderCompress(level == Level::best ? BROTLI_MAX_QUALITY : 4, BROTLI_DEFAULT_WINDOW,
+                              BROTLI_MODE_TEXT, data.size(), reinterpret_cast<const unsigned char *>(data.data()),
+                              &encodedSize, reinterpret_cast<unsigned char *>(encodedData.data())) != BROTLI_TRUE) {
+        throw Exception{
+            Log{Log::Level::error, "brotli compress failed", sourceLocation}
+        };
+    }
+
+    encodedData.resize(encodedSize);
+
+    return encodedData;
+}
+
+auto Compressor::zstd(const std::span<const std::byte> data, const Level level,
+                      const std::source_location sourceLocation) -> std::vector<std::byte> {
+    std::vector<std::byte> encodedData{ZSTD_compressBound(data.size())};
+
+    ZSTD_CCtx_reset(this->zstdContext.get(), ZSTD_reset_session_only);
+    ZSTD_CCtx_setParameter(this->zstdContext.get(), ZSTD_c_compressionLevel, level == Level::best ? 19 : 1);
+    const unsigned long encodedSize{ZSTD_compress2(this->zstdContext.get(), encodedData.data(), encodedData.size(),
+                                                   data.data(), data.size())};
+    if (ZSTD_isError(encodedSize) != 0) {
+        throw Exception{
+            Log{Log::Level::error, std::string{"zstd compress failed: "} + ZSTD_getErrorName(encodedSize),
+                sourceLocation}
+        };
+    }
+
+    encodedData.resize(encodedSize);
+
+    return encodedData;
+}
+
+auto Compressor::gzip(const std::span<const std::byte> data, const Level level,
+                      const std::source_location sourceLocation) -> std::vector<std::byte> {
+    z_stream &stream{*this->gzipStreams[std::to_underlying(level)]};
+    if (deflateReset(&stream) != Z_OK) {
+        throw Exception{
+            Log{Log::Level::error, "gzip reset failed", sourceLocation}
+        };
+    }
+
+    std::vector<std::byte> encodedData{deflateBound(&stream, data.size())};
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<std::byte *>(data.data()));
+    stream.avail_in = static_cast<unsigned int>(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(encodedData.data());
+    stream.avail_out = static_cast<unsigned int>(encodedData.size());
+
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        throw Exception{
+            Log{Log::Level::error, "gzip compress failed", sourceLocation}
+        };
+    }
+
+    encodedData.resize(stream.total_out);
+
+    return encodedData;
+}
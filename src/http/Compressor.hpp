@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <source_location>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <zlib.h>
+#include <zstd.h>
+
+// the content codings a response can be sent with, one instance per thread keeps the gzip and zstd contexts across
+// responses, since setting them up again costs more than compressing a small body
+class Compressor {
+    struct Deleter {
+        auto operator()(z_stream *stream) const noexcept -> void;
+
+        auto operator()(ZSTD_CCtx *context) const noexcept -> void;
+    };
+
+public:
+    // in the order of preference when the client weighs codings equally
+    enum class Coding : unsigned char { brotli, zstd, gzip, identity };
+
+    // static files are compressed once per version so they can take the best level, dynamic bodies every time
+    enum class Level : unsigned char { fast, best };
+
+    // picks the coding of the highest q-value from an Accept-Encoding value, a missing header means identity
+    [[nodiscard]] static auto negotiate(std::string_view acceptEncoding) -> Coding;
+
+    [[nodiscard]] static auto getName(Coding coding) noexcept -> std::string_view;
+
+    explicit Compressor(std::source_location sourceLocation = std::source_location::current());
+
+    Compressor(const Compressor &) = delete;
+
+    Compressor(Compressor &&) noexcept = default;
+
+    auto operator=(const Compressor &) -> Compressor & = delete;
+
+    auto operator=(Compressor &&) noexcept -> Compressor & = default;
+
+    ~Compressor() = default;
+
+    [[nodiscard]] auto compress(std::span<const std::byte> data, Coding coding, Level level,
+                                std::source_location sourceLocation = std::source_location::current())
+        -> std::vector<std::byte>;
+
+private:
+    [[nodiscard]] static auto brotli(std::span<const std::byte> data, Level level, std::source_location sourceLocation)
+        -> std::vector<std::byte>;
+
+    [[nodiscard]] auto zstd(std::span<const std::byte> data, Level level, std::source_location sourceLocation)
+        -> std::vector<std::byte>;
+
+    [[nodiscard]] auto gzip(std::span<const std::byte> data, Level level, std::source_location sourceLocation)
+        -> std::vector<std::byte>;
+
+    // one stream per level, as older zlib flushes when the level of a reset stream changes, and zlib points back at
+    // a stream from its state, so each stays where it was initialized
+    std::array<std::unique_ptr<z_stream, Deleter>, 2> gzipStreams;
+    std::unique_ptr<ZSTD_CCtx, Deleter> zstdContext;
+};
@@ -0,0 +1,336 @@
+#include "Hpack.hpp"
+
+#include "../log/Exception.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+// appendix a of rfc 7541, index 1 is the first entry
+constexpr std::array<std::pair<std::string_view, std::string_view>, 61> staticTable{{
+        {":authority", ""},
+        {":method", "GET"},
+        {":method", "POST"},
+        {":path", "/"},
+        {":path", "/index.html"},
+        {":scheme", "http"},
+        {":scheme", "https"},
+        {":status", "200"},
+        {":status", "204"},
+        {":status", "206"},
+        {":status", "304"},
+        {":status", "400"},
+        {":status", "404"},
+        {":status", "500"},
+        {"accept-charset", ""},
+        {"accept-encoding", "gzip, deflate"},
+        {"accept-language", ""},
+        {"accept-ranges", ""},
+        {"accept", ""},
+        {"access-control-allow-origin", ""},
+        {"age", ""},
+        {"allow", ""},
+        {"authorization", ""},
+        {"cache-control", ""},
+        {"content-disposition", ""},
+        {"content-encoding", ""},
+        {"content-language", ""},
+        {"content-length", ""},
+        {"content-location", ""},
+        {"content-range", ""},
+        {"content-type", ""},
+        {"cookie", ""},
+        {"date", ""},
+        {"etag", ""},
+        {"expect", ""},
+        {"expires", ""},
+        {"from", ""},
+        {"host", ""},
+        {"if-match", ""},
+        {"if-modified-since", ""},
+        {"if-none-match", ""},
+        {"if-range", ""},
+        {"if-unmodified-since", ""},
+        {"last-modified", ""},
+        {"link", ""},
+        {"location", ""},
+        {"max-forwards", ""},
+        {"proxy-authenticate", ""},
+        {"proxy-authorization", ""},
+        {"range", ""},
+        {"referer", ""},
+        {"refresh", ""},
+        {"retry-after", ""},
+        {"server", ""},
+        {"set-cookie", ""},
+        {"strict-transport-security", ""},
+        {"transfer-encoding", ""},
+        {"user-agent", ""},
+        {"vary", ""},
+        {"via", ""},
+        {"www-authenticate", ""},
+}};
+
+// appendix b of rfc 7541, codes are right aligned
+constexpr std::array<unsigned int, 256> huffmanCodes{
+        0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+        0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+        0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+        0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+        0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+        0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+        0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+        0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+        0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+        0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+        0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+        0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+        0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+        0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+        0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+        0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+        0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+        0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+        0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+        0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+        0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+        0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+        0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+        0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+        0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+        0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+        0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+        0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+        0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+        0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+        0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+        0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+};
+
+constexpr std::array<unsigned char, 256> huffmanLengths{
+        13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 30, 28,
+        28, 28, 28, 28, 28, 28, 28, 28, 6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+        5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10, 13, 6, 7, 7, 7, 7, 7, 7,
+        7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+        15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5, 6, 7, 6, 5, 5, 6, 7, 7,
+        7, 7, 7, 15, 11, 14, 13, 28, 20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+        24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24, 22, 21, 20, 22, 22, 23, 23, 21,
+        23, 22, 22, 24, 21, 22, 23, 23, 21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+        26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25, 19, 21, 26, 27, 27, 26, 27, 24,
+        21, 21, 26, 26, 28, 27, 27, 27, 20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+        26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+};
+
+// a binary tree over the codes, a negative child is the symbol it ends in minus one
+[[nodiscard]] auto createHuffmanTree() -> std::vector<std::array<short, 2>> {
+    std::vector<std::array<short, 2>> tree(1);
+    for (unsigned int symbol{}; symbol != huffmanCodes.size(); ++symbol) {
+        unsigned long node{};
+        for (unsigned int i{huffmanLengths[symbol]}; i != 0; --i) {
+            const unsigned int bit{huffmanCodes[symbol] >> (i - 1) & 1};
+            if (i == 1) tree[node][bit] = static_cast<short>(-static_cast<int>(symbol) - 1);
+            else {
+                if (tree[node][bit] == 0) {
+                    tree[node][bit] = static_cast<short>(tree.size());
+                    tree.emplace_back();
+                }
+                node = tree[node][bit];
+            }
+        }
+    }
+
+    return tree;
+}
+
+auto Hpack::encode(const std::string_view name, const std::string_view value, std::vector<std::byte> &output)
+    -> void {
+    unsigned long nameIndex{};
+    for (unsigned long i{}; i != staticTable.size(); ++i) {
+        if (staticTable[i].first != name) continue;
+
+        if (staticTable[i].second == value) {
+            encodeInteger(i + 1, 7, std::byte{0x80}, output);
+
+            return;
+        }
+        if (nameIndex == 0) nameIndex = i + 1;
+    }
+
+    // a literal without indexing, the peer's dynamic table is left alone
+    encodeInteger(nameIndex, 4, std::byte{}, output);
+    if (nameIndex == 0) {
+        encodeInteger(name.size(), 7, std::byte{}, output);
+        output.insert(output.cend(), reinterpret_cast<const std::byte *>(name.data()),
+                      reinterpret_cast<const std::byte *>(name.data() + name.size()));
+    }
+    encodeInteger(value.size(), 7, std::byte{}, output);
+    output.insert(output.cend(), reinterpret_cast<const std::byte *>(value.data()),
+                  reinterpret_cast<const std::byte *>(value.data() + value.size()));
+}
+
+Hpack::Hpack(const unsigned long maxTableSize) noexcept : tableCapacity{maxTableSize}, maxTableSize{maxTableSize} {}
+
+auto Hpack::decode(const std::span<const std::byte> block, const std::source_location sourceLocation)
+    -> std::vector<Field> {
+    std::vector<Field> fields;
+    unsigned long listSize{};
+
+    for (unsigned long offset{}; offset != block.size();) {
+        const auto first{static_cast<unsigned char>(block[offset])};
+
+        if ((first & 0x80) != 0) {
+            fields.emplace_back(this->getField(decodeInteger(block, offset, 7, sourceLocation), sourceLocation));
+        } else if ((first & 0x20) != 0 && (first & 0x40) == 0) {
+            // a table size update, bounded by the size the settings allow
+            const unsigned long capacity{decodeInteger(block, offset, 5, sourceLocation)};
+            if (capacity > this->maxTableSize) {
+                throw Exception{
+                    Log{Log::Level::warn, "hpack table size update above the limit", sourceLocation}
+                };
+            }
+
+            this->tableCapacity = capacity;
+            this->evict();
+
+            continue;
+        } else {
+            const bool isIndexed{(first & 0x40) != 0};
+            const unsigned long nameIndex{decodeInteger(block, offset, isIndexed ? 6 : 4, sourceLocation)};
+
+            Field field{nameIndex == 0 ? Field{decodeString(block, offset, sourceLocation), {}} :
+                                         this->getField(nameIndex, sourceLocation)};
+            field.value = decodeString(block, offset, sourceLocation);
+
+            if (isIndexed) this->insert(field);
+            fields.emplace_back(std::move(field));
+        }
+
+        listSize += fields.back().name.size() + fields.back().value.size() + 32;
+        if (listSize > maxListSize) {
+            throw Exception{
+                Log{Log::Level::warn, "hpack header list too large", sourceLocation}
+            };
+        }
+    }
+
+    return fields;
+}
+
+auto Hpack::decodeInteger(const std::span<const std::byte> block, unsigned long &offset, const unsigned int prefixBits,
+                          const std::source_location sourceLocation) -> unsigned long {
+    const unsigned long prefixMax{(1UL << prefixBits) - 1};
+    unsigned long value{static_cast<unsigned char>(block[offset++]) & prefixMax};
+    if (value != prefixMax) return value;
+
+    for (unsigned int shift{}; offset != block.size() && shift <= 28; shift += 7) {
+        const auto byte{static_cast<unsigned char>(block[offset++])};
+        value += static_cast<unsigned long>(byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0) return value;
+    }
+
+    throw Exception{
+        Log{Log::Level::warn, "hpack integer truncated or too large", sourceLocation}
+    };
+}
+
+auto Hpack::decodeString(const std::span<const std::byte> block, unsigned long &offset,
+                         const std::source_location sourceLocation) -> std::string {
+    if (offset == block.size()) {
+        throw Exception{
+            Log{Log::Level::warn, "hpack string truncated", sourceLocation}
+        };
+    }
+
+    const bool isHuffman{(static_cast<unsigned char>(block[offset]) & 0x80) != 0};
+    const unsigned long size{decodeInteger(block, offset, 7, sourceLocation)};
+    if (size > block.size() - offset) {
+        throw Exception{
+            Log{Log::Level::warn, "hpack string truncated", sourceLocation}
+        };
+    }
+
+    const std::span data{block.subspan(offset, size)};
+    offset += size;
+
+    return isHuffman ? decodeHuffman(data, sourceLocation) :
+                       std::string{reinterpret_cast<const char *>(data.data()), data.size()};
+}
+
+auto Hpack::decodeHuffman(const std::span<const std::byte> data, const std::source_location sourceLocation)
+    -> std::string {
+    static const std::vector tree{createHuffmanTree()};
+
+    std::string string;
+    unsigned long node{};
+    unsigned int paddingBits{};
+    bool isPaddingOnes{true};
+    for (const std::byte byte : data) {
+        for (unsigned int i{8}; i != 0; --i) {
+            const unsigned int bit{static_cast<unsigned int>(byte >> (i - 1)) & 1};
+            const short child{tree[node][bit]};
+            ++paddingBits;
+            isPaddingOnes = isPaddingOnes && bit == 1;
+
+            if (child < 0) {
+                string += static_cast<char>(-child - 1);
+                node = 0;
+                paddingBits = 0;
+                isPaddingOnes = true;
+            } else if (child == 0) {
+                throw Exception{
+                    Log{Log::Level::warn, "hpack huffman code invalid", sourceLocation}
+                };
+            } else node = child;
+        }
+    }
+
+    // the end is padded with at most seven bits of the end of string code, which is all ones
+    if (paddingBits > 7 || !isPaddingOnes) {
+        throw Exception{
+            Log{Log::Level::warn, "hpack huffman padding invalid", sourceLocation}
+        };
+    }
+
+    return string;
+}
+
+auto Hpack::encodeInteger(const unsigned long value, const unsigned int prefixBits, const std::byte flags,
+                          std::vector<std::byte> &output) -> void {
+    const unsigned long prefixMax{(1UL << prefixBits) - 1};
+    if (value < prefixMax) {
+        output.emplace_back(flags | static_cast<std::byte>(value));
+
+        return;
+    }
+
+    output.emplace_back(flags | static_cast<std::byte>(prefixMax));
+    unsigned long rest{value - prefixMax};
+    for (; rest >= 0x80; rest >>= 7) output.emplace_back(static_cast<std::byte>((rest & 0x7f) | 0x80));
+    output.emplace_back(static_cast<std::byte>(rest));
+}
+
+auto Hpack::getField(const unsigned long index, const std::source_location sourceLocation) const -> Field {
+    if (index != 0 && index <= staticTable.size())
+        return Field{std::string{staticTable[index - 1].first}, std::string{staticTable[index - 1].second}};
+    if (index > staticTable.size() && index - staticTable.size() <= this->dynamicTable.size())
+        return this->dynamicTable[index - staticTable.size() - 1];
+
+    throw Exception{
+        Log{Log::Level::warn, "hpack index out of range", sourceLocation}
+    };
+}
+
+auto Hpack::insert(Field field) -> void {
+    // an entry larger than the whole table empties it and is not added
+    this->tableSize += field.name.size() + field.value.size() + 32;
+    this->dynamicTable.emplace_front(std::move(field));
+    this->evict();
+}
+
+auto Hpack::evict() noexcept -> void {
+    while (this->tableSize > this->tableCapacity) {
+        this->tableSize -= this->dynamicTable.back().name.size() + this->dynamicTable.back().value.size() + 32;
+        this->dynamicTable.pop_back();
+    }
+}
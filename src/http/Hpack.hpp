@@ -0,0 +1,50 @@
+#pragma once
+
+#include <deque>
+#include <source_location>
+#include <span>
+#include <string>
+#include <vector>
+
+// header compression of rfc 7541, the decoder keeps the dynamic table of a connection, the encoder only emits
+// literals that are never added to the peer's table, so it needs no state
+class Hpack {
+public:
+    struct Field {
+        std::string name, value;
+    };
+
+    static auto encode(std::string_view name, std::string_view value, std::vector<std::byte> &output) -> void;
+
+    explicit Hpack(unsigned long maxTableSize = 4096) noexcept;
+
+    [[nodiscard]] auto decode(std::span<const std::byte> block,
+                              std::source_location sourceLocation = std::source_location::current())
+        -> std::vector<Field>;
+
+private:
+    // bounds what a small header block can expand into
+    static constexpr unsigned long maxListSize{64 * 1024};
+
+    [[nodiscard]] static auto decodeInteger(std::span<const std::byte> block, unsigned long &offset,
+                                            unsigned int prefixBits, std::source_location sourceLocation)
+        -> unsigned long;
+
+    [[nodiscard]] static auto decodeString(std::span<const std::byte> block, unsigned long &offset,
+                                           std::source_location sourceLocation) -> std::string;
+
+    [[nodiscard]] static auto decodeHuffman(std::span<const std::byte> data, std::source_location sourceLocation)
+        -> std::string;
+
+    static auto encodeInteger(unsigned long value, unsigned int prefixBits, std::byte flags,
+                              std::vector<std::byte> &output) -> void;
+
+    [[nodiscard]] auto getField(unsigned long index, std::source_location sourceLocation) const -> Field;
+
+    auto insert(Field field) -> void;
+
+    auto evict() noexcept -> void;
+
+    std::deque<Field> dynamicTable;
+    unsigned long tableSize{}, tableCapacity, maxTableSize;
+};
@@ -0,0 +1,532 @@
+#include "Http2Session.hpp"
+
+#include "../log/Exception.hpp"
+
+#include <algorithm>
+#include <array>
+#include <ranges>
+#include <utility>
+
+// http/1.1 parsing matches header names exactly, http/2 sends them in lower case
+[[nodiscard]] static auto toCanonicalName(const std::string_view name) -> std::string {
+    std::string canonicalName{name};
+    for (unsigned long i{}; i != canonicalName.size(); ++i) {
+        if (i == 0 || canonicalName[i - 1] == '-')
+            canonicalName[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(canonicalName[i])));
+    }
+
+    return canonicalName;
+}
+
+[[nodiscard]] static auto toLowerName(const std::string_view name) -> std::string {
+    std::string lowerName{name};
+    std::ranges::transform(lowerName, lowerName.begin(),
+                           [](const char character) { return static_cast<char>(std::tolower(character)); });
+
+    return lowerName;
+}
+
+[[nodiscard]] static auto toBytes(const unsigned int value) noexcept -> std::array<std::byte, 4> {
+    return {static_cast<std::byte>(value >> 24), static_cast<std::byte>(value >> 16),
+            static_cast<std::byte>(value >> 8), static_cast<std::byte>(value)};
+}
+
+Http2Session::Http2Session() {
+    // the only setting differing from the defaults, the peer may start sending right away
+    constexpr std::array settings{std::byte{0x00}, std::byte{0x03}, std::byte{0x00},
+                                  std::byte{0x00}, std::byte{0x00}, std::byte{maxStreamCount}};
+    this->writeFrame(FrameType::settings, std::byte{}, 0, settings);
+}
+
+auto Http2Session::receive(const std::span<const std::byte> data) -> std::vector<Request> {
+    std::vector<Request> requests;
+    if (this->isGoneAway) return requests;
+
+    this->input.insert(this->input.cend(), data.cbegin(), data.cend());
+    const std::span<const std::byte> received{this->input};
+
+    unsigned long offset{};
+    if (!this->isPrefaceReceived) {
+        const std::string_view text{reinterpret_cast<const char *>(received.data()), received.size()};
+        if (!preface.starts_with(text.substr(0, preface.size()))) {
+            this->goAway(ErrorCode::protocolError);
+
+            return requests;
+        }
+        if (text.size() < preface.size()) return requests;
+
+        this->isPrefaceReceived = true;
+        offset = preface.size();
+    }
+
+    while (!this->isGoneAway && received.size() - offset >= frameHeaderSize) {
+        const std::span header{received.subspan(offset, frameHeaderSize)};
+        const unsigned int length{static_cast<unsigned int>(header[0]) << 16 |
+                                  static_cast<unsigned int>(header[1]) << 8 | static_cast<unsigned int>(header[2])};
+        if (length > maxFrameSize) {
+            this->goAway(ErrorCode::frameSizeError);
+
+            break;
+        }
+        if (received.size() - offset - frameHeaderSize < length) break;
+
+        this->handleFrame(static_cast<FrameType>(header[3]), header[4], readNumber(header.subspan(5)) & 0x7fffffff,
+                          received.subspan(offset + frameHeaderSize, length), requests);
+        offset += frameHeaderSize + length;
+    }
+
+    this->input.erase(this->input.cbegin(), this->input.cbegin() + static_cast<long>(offset));
+
+    return requests;
+}
+
+auto Http2Session::respond(const unsigned int streamId, const std::span<const std::byte> response) -> void {
+    const auto element{this->streams.find(streamId)};
+    if (this->isGoneAway || element == this->streams.end()) return;
+
+    // the status line and headers of the parser's response, "HTTP/1.1 200 OK\r\n..."
+    const std::string_view text{reinterpret_cast<const char *>(response.data()), response.size()};
+    const unsigned long headerEnd{text.find("\r\n\r\n")};
+    if (text.size() < 12 || headerEnd == std::string_view::npos) {
+        this->resetStream(streamId, ErrorCode::internalError);
+
+        return;
+    }
+
+    std::vector<std::byte> block;
+    Hpack::encode(":status", text.substr(9, 3), block);
+    for (unsigned long lineStart{text.find("\r\n") + 2}; lineStart < headerEnd;) {
+        const unsigned long lineEnd{text.find("\r\n", lineStart)};
+        const std::string_view line{text.substr(lineStart, lineEnd - lineStart)};
+        lineStart = lineEnd + 2;
+
+        const unsigned long splitPoint{line.find(": ")};
+        if (splitPoint == std::string_view::npos) continue;
+
+        // connection specific headers are malformed in http/2
+        const std::string name{toLowerName(line.substr(0, splitPoint))};
+        if (name == "connection" || name == "keep-alive" || name == "transfer-encoding" || name == "upgrade") continue;
+
+        Hpack::encode(name, line.substr(splitPoint + 2), block);
+    }
+
+    Stream &stream{element->second};
+    const std::span body{response.subspan(headerEnd + 4)};
+
+    // a header block longer than a frame goes on in continuation frames
+    const std::span<const std::byte> blockView{block};
+    for (unsigned long blockOffset{}; blockOffset < block.size(); blockOffset += maxFrameSize) {
+        const std::span fragment{
+            blockView.subspan(blockOffset, std::min<unsigned long>(maxFrameSize, block.size() - blockOffset))};
+        std::byte flags{blockOffset + fragment.size() == block.size() ? endHeaders : std::byte{}};
+        if (blockOffset == 0 && body.empty()) flags |= endStream;
+
+        this->writeFrame(blockOffset == 0 ? FrameType::headers : FrameType::continuation, flags, streamId, fragment);
+    }
+
+    if (body.empty()) {
+        this->streams.erase(element);
+
+        return;
+    }
+
+    stream.data.assign(body.cbegin(), body.cend());
+    this->pump();
+}
+
+auto Http2Session::hasOutput() const noexcept -> bool { return !this->output.empty(); }
+
+auto Http2Session::takeOutput() -> std::vector<std::byte> { return std::exchange(this->output, {}); }
+
+auto Http2Session::isClosed() const noexcept -> bool { return this->isGoneAway; }
+
+auto Http2Session::readNumber(const std::span<const std::byte> bytes) noexcept -> unsigned int {
+    return static_cast<unsigned int>(bytes[0]) << 24 | static_cast<unsigned int>(bytes[1]) << 16 |
+           static_cast<unsigned int>(bytes[2]) << 8 | static_cast<unsigned int>(bytes[3]);
+}
+
+auto Http2Session::handleFrame(const FrameType type, const std::byte flags, const unsigned int streamId,
+                               const std::span<const std::byte> payload, std::vector<Request> &requests) -> void {
+    // a header block is never interleaved with other frames
+    if (this->headerStreamId != 0 && (type != FrameType::continuation || streamId != this->headerStreamId)) {
+        this->goAway(ErrorCode::protocolError);
+
+        return;
+    }
+
+    switch (type) {
+        case FrameType::data:
+            this->handleData(flags, streamId, payload, requests);
+
+            break;
+        case FrameType::headers:
+            this->handleHeaders(flags, streamId, payload, requests);
+
+            break;
+        case FrameType::priority:
+            if (streamId == 0) this->goAway(ErrorCode::protocolError);
+            else if (payload.size() != 5) this->resetStream(streamId, ErrorCode::frameSizeError);
+
+            break;
+        case FrameType::resetStream:
+            if (streamId == 0 || streamId > this->lastStreamId) this->goAway(ErrorCode::protocolError);
+            else if (payload.size() != 4) this->goAway(ErrorCode::frameSizeError);
+            else this->streams.erase(streamId);
+
+            break;
+        case FrameType::settings:
+            this->handleSettings(flags, streamId, payload);
+
+            break;
+        case FrameType::pushPromise:
+            this->goAway(ErrorCode::protocolError);
+
+            break;
+        case FrameType::ping:
+            if (streamId != 0) this->goAway(ErrorCode::protocolError);
+            else if (payload.size() != 8) this->goAway(ErrorCode::frameSizeError);
+            else if ((flags & ack) == std::byte{}) this->writeFrame(FrameType::ping, ack, 0, payload);
+
+            break;
+        case FrameType::goAway:
+            // the peer closes the connection once its open streams are answered
+            if (streamId != 0) this->goAway(ErrorCode::protocolError);
+
+            break;
+        case FrameType::windowUpdate:
+            this->handleWindowUpdate(streamId, payload);
+
+            break;
+        case FrameType::continuation:
+            if (this->headerStreamId == 0) {
+                this->goAway(ErrorCode::protocolError);
+
+                break;
+            }
+
+            this->headerBlock.insert(this->headerBlock.cend(), payload.cbegin(), payload.cend());
+            if (this->headerBlock.size() > maxHeaderBlockSize) this->goAway(ErrorCode::enhanceYourCalm);
+            else if ((flags & endHeaders) != std::byte{}) this->finishHeaders(requests);
+
+            break;
+        default:
+            // unknown frame types are ignored
+            break;
+    }
+}
+
+auto Http2Session::handleData(const std::byte flags, const unsigned int streamId,
+                              const std::span<const std::byte> payload, std::vector<Request> &requests) -> void {
+    if (streamId == 0 || streamId > this->lastStreamId) {
+        this->goAway(ErrorCode::protocolError);
+
+        return;
+    }
+
+    // the connection window is handed back right away, stream windows are not, which bounds a request body
+    const auto size{static_cast<long>(payload.size())};
+    this->receiveWindow -= size;
+    if (this->receiveWindow < 0) {
+        this->goAway(ErrorCode::flowControlError);
+
+        return;
+    }
+    if (size != 0) {
+        this->writeFrame(FrameType::windowUpdate, std::byte{}, 0, toBytes(static_cast<unsigned int>(size)));
+        this->receiveWindow += size;
+    }
+
+    const auto element{this->streams.find(streamId)};
+    if (element == this->streams.end() || element->second.isReceived || !element->second.isHeaderReceived) {
+        this->resetStream(streamId, ErrorCode::streamClosed);
+
+        return;
+    }
+
+    Stream &stream{element->second};
+    stream.receiveWindow -= size;
+    if (stream.receiveWindow < 0) {
+        this->resetStream(streamId, ErrorCode::flowControlError);
+
+        return;
+    }
+
+    std::span data{payload};
+    if ((flags & padded) != std::byte{}) {
+        const unsigned int paddingSize{data.empty() ? 0 : static_cast<unsigned int>(data[0])};
+        if (data.empty() || paddingSize >= data.size()) {
+            this->goAway(ErrorCode::protocolError);
+
+            return;
+        }
+
+        data = data.subspan(1, data.size() - 1 - paddingSize);
+    }
+    stream.body.append(reinterpret_cast<const char *>(data.data()), data.size());
+
+    if ((flags & endStream) != std::byte{}) this->complete(streamId, stream, requests);
+}
+
+auto Http2Session::handleHeaders(const std::byte flags, const unsigned int streamId,
+                                 const std::span<const std::byte> payload, std::vector<Request> &requests) -> void {
+    if (streamId == 0 || streamId % 2 == 0) {
+        this->goAway(ErrorCode::protocolError);
+
+        return;
+    }
+
+    std::span fragment{payload};
+    unsigned int paddingSize{};
+    if ((flags & padded) != std::byte{}) {
+        if (fragment.empty()) {
+            this->goAway(ErrorCode::protocolError);
+
+            return;
+        }
+
+        paddingSize = static_cast<unsigned int>(fragment[0]);
+        fragment = fragment.subspan(1);
+    }
+    if ((flags & priority) != std::byte{}) {
+        if (fragment.size() < 5) {
+            this->goAway(ErrorCode::protocolError);
+
+            return;
+        }
+
+        fragment = fragment.subspan(5);
+    }
+    if (paddingSize > fragment.size()) {
+        this->goAway(ErrorCode::protocolError);
+
+        return;
+    }
+    fragment = fragment.first(fragment.size() - paddingSize);
+
+    if (const auto element{this->streams.find(streamId)}; element != this->streams.end()) {
+        // trailers have to end the stream
+        if (element->second.isReceived || (flags & endStream) == std::byte{}) {
+            this->goAway(ErrorCode::protocolError);
+
+            return;
+        }
+    } else if (streamId <= this->lastStreamId) {
+        this->goAway(ErrorCode::streamClosed);
+
+        return;
+    } else {
+        this->lastStreamId = streamId;
+        this->streams.emplace(streamId, Stream{{}, {}, {}, 0, this->initialWindow, defaultWindow, false, false});
+    }
+
+    this->headerStreamId = streamId;
+    this->headerBlock.assign(fragment.cbegin(), fragment.cend());
+    this->isHeaderEndStream = (flags & endStream) != std::byte{};
+
+    if ((flags & endHeaders) != std::byte{}) this->finishHeaders(requests);
+}
+
+auto Http2Session::handleSettings(const std::byte flags, const unsigned int streamId,
+                                  const std::span<const std::byte> payload) -> void {
+    if (streamId != 0) {
+        this->goAway(ErrorCode::protocolError);
+
+        return;
+    }
+    if ((flags & ack) != std::byte{}) {
+        if (!payload.empty()) this->goAway(ErrorCode::frameSizeError);
+
+        return;
+    }
+    if (payload.size() % 6 != 0) {
+        this->goAway(ErrorCode::frameSizeError);
+
+        return;
+    }
+
+    for (unsigned long offset{}; offset != payload.size(); offset += 6) {
+        const unsigned int identifier{static_cast<unsigned int>(payload[offset]) << 8 |
+                                      static_cast<unsigned int>(payload[offset + 1])},
+            value{readNumber(payload.subspan(offset + 2))};
+
+        if (identifier == 0x2 && value > 1) {
+            this->goAway(ErrorCode::protocolError);
+
+            return;
+        }
+        if (identifier == 0x4) {
+            if (value > maxWindow) {
+                this->goAway(ErrorCode::flowControlError);
+
+                return;
+            }
+
+            // a new initial window shifts the windows of every open stream by the difference
+            const long delta{static_cast<long>(value) - this->initialWindow};
+            this->initialWindow = value;
+            for (Stream &stream : this->streams | std::views::values) stream.sendWindow += delta;
+        }
+        // frames are never sent larger than the minimum every peer accepts, so only the range is checked
+        if (identifier == 0x5 && (value < maxFrameSize || value > 0xffffff)) {
+            this->goAway(ErrorCode::protocolError);
+
+            return;
+        }
+    }
+
+    this->writeFrame(FrameType::settings, ack, 0, {});
+    this->pump();
+}
+
+auto Http2Session::handleWindowUpdate(const unsigned int streamId, const std::span<const std::byte> payload)
+    -> void {
+    if (payload.size() != 4) {
+        this->goAway(ErrorCode::frameSizeError);
+
+        return;
+    }
+
+    const long increment{readNumber(payload) & 0x7fffffff};
+    if (streamId == 0) {
+        if (increment == 0) this->goAway(ErrorCode::protocolError);
+        else if (this->sendWindow + increment > maxWindow) this->goAway(ErrorCode::flowControlError);
+        else this->sendWindow += increment;
+    } else if (const auto element{this->streams.find(streamId)}; element != this->streams.end()) {
+        if (increment == 0) this->resetStream(streamId, ErrorCode::protocolError);
+        else if (element->second.sendWindow + increment > maxWindow)
+            this->resetStream(streamId, ErrorCode::flowControlError);
+        else element->second.sendWindow += increment;
+    }
+
+    this->pump();
+}
+
+auto Http2Session::finishHeaders(std::vector<Request> &requests) -> void {
+    const unsigned int streamId{std::exchange(this->headerStreamId, 0)};
+
+    // every block is decoded, even of a refused stream, to keep the dynamic table in step with the peer
+    std::vector<Hpack::Field> fields;
+    try {
+        fields = this->hpack.decode(this->headerBlock);
+    } catch (Exception &) {
+        this->goAway(ErrorCode::compressionError);
+
+        return;
+    }
+
+    const auto element{this->streams.find(streamId)};
+    if (element == this->streams.end()) return;
+
+    Stream &stream{element->second};
+    if (!stream.isHeaderReceived) {
+        if (this->streams.size() > maxStreamCount) {
+            this->resetStream(streamId, ErrorCode::refusedStream);
+
+            return;
+        }
+
+        stream.fields = std::move(fields);
+        stream.isHeaderReceived = true;
+    }
+
+    if (this->isHeaderEndStream) this->complete(streamId, stream, requests);
+}
+
+auto Http2Session::complete(const unsigned int streamId, Stream &stream, std::vector<Request> &requests) -> void {
+    stream.isReceived = true;
+
+    std::string_view method, path, authority;
+    std::string headers;
+    bool hasContentLength{};
+    for (const auto &[name, value] : stream.fields) {
+        if (name == ":method") method = value;
+        else if (name == ":path") path = value;
+        else if (name == ":authority") authority = value;
+        else if (!name.starts_with(':')) {
+            hasContentLength = hasContentLength || name == "content-length";
+            headers += toCanonicalName(name) + ": " + value + "\r\n";
+        }
+    }
+
+    if (method.empty() || path.empty()) {
+        this->resetStream(streamId, ErrorCode::protocolError);
+
+        return;
+    }
+
+    std::string request{std::string{method} + ' ' + std::string{path} + " HTTP/1.1\r\n"};
+    if (!authority.empty()) request += "Host: " + std::string{authority} + "\r\n";
+    request += headers;
+    if (!stream.body.empty() && !hasContentLength)
+        request += "Content-Length: " + std::to_string(stream.body.size()) + "\r\n";
+    request += "\r\n" + stream.body;
+
+    stream.fields.clear();
+    stream.body.clear();
+
+    requests.emplace_back(streamId, std::move(request));
+}
+
+auto Http2Session::pump() -> void {
+    // one frame per stream and round, so a large response doesn't hold back the others
+    for (bool isProgressing{true}; isProgressing && this->sendWindow > 0;) {
+        isProgressing = false;
+
+        for (auto element{this->streams.begin()}; element != this->streams.end() && this->sendWindow > 0;) {
+            Stream &stream{element->second};
+            const unsigned long remainingSize{stream.data.size() - stream.sentSize};
+            if (remainingSize == 0 || stream.sendWindow <= 0) {
+                ++element;
+
+                continue;
+            }
+
+            const unsigned long size{std::min({remainingSize, static_cast<unsigned long>(maxFrameSize),
+                                               static_cast<unsigned long>(this->sendWindow),
+                                               static_cast<unsigned long>(stream.sendWindow)})};
+            const bool isLast{size == remainingSize};
+            this->writeFrame(FrameType::data, isLast ? endStream : std::byte{}, element->first,
+                             std::span{stream.data}.subspan(stream.sentSize, size));
+
+            stream.sentSize += size;
+            stream.sendWindow -= static_cast<long>(size);
+            this->sendWindow -= static_cast<long>(size);
+            isProgressing = true;
+
+            element = isLast ? this->streams.erase(element) : std::next(element);
+        }
+    }
+}
+
+auto Http2Session::writeFrame(const FrameType type, const std::byte flags, const unsigned int streamId,
+                              const std::span<const std::byte> payload) -> void {
+    const auto size{static_cast<unsigned int>(payload.size())};
+    const std::array<std::byte, 4> streamBytes{toBytes(streamId)};
+    const std::array header{static_cast<std::byte>(size >> 16),
+                            static_cast<std::byte>(size >> 8),
+                            static_cast<std::byte>(size),
+                            static_cast<std::byte>(type),
+                            flags,
+                            streamBytes[0],
+                            streamBytes[1],
+                            streamBytes[2],
+                            streamBytes[3]};
+
+    this->output.insert(this->output.cend(), header.cbegin(), header.cend());
+    this->output.insert(this->output.cend(), payload.cbegin(), payload.cend());
+}
+
+auto Http2Session::resetStream(const unsigned int streamId, const ErrorCode errorCode) -> void {
+    this->writeFrame(FrameType::resetStream, std::byte{}, streamId, toBytes(std::to_underlying(errorCode)));
+    this->streams.erase(streamId);
+}
+
+auto Http2Session::goAway(const ErrorCode errorCode) -> void {
+    const std::array lastStream{toBytes(this->lastStreamId)}, error{toBytes(std::to_underlying(errorCode))};
+    const std::array payload{lastStream[0], lastStream[1], lastStream[2], lastStream[3],
+                             error[0],      error[1],      error[2],      error[3]};
+    this->writeFrame(FrameType::goAway, std::byte{}, 0, payload);
+
+    this->streams.clear();
+    this->isGoneAway = true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Hpack.hpp"
+
+#include <map>
+
+// the http/2 side of a connection opened with prior knowledge, requests are translated into http/1.1 for the parser
+// and its responses framed back onto their streams
+class Http2Session {
+public:
+    struct Request {
+        unsigned int streamId;
+        std::string request;
+    };
+
+    static constexpr std::string_view preface{"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"};
+
+    Http2Session();
+
+    // consumes received bytes and returns the requests they completed
+    [[nodiscard]] auto receive(std::span<const std::byte> data) -> std::vector<Request>;
+
+    auto respond(unsigned int streamId, std::span<const std::byte> response) -> void;
+
+    [[nodiscard]] auto hasOutput() const noexcept -> bool;
+
+    // the frames flow control lets out now, the rest follows window updates
+    [[nodiscard]] auto takeOutput() -> std::vector<std::byte>;
+
+    // set once a connection error was answered with a goaway, nothing more is read
+    [[nodiscard]] auto isClosed() const noexcept -> bool;
+
+private:
+    enum class FrameType : unsigned char {
+        data,
+        headers,
+        priority,
+        resetStream,
+        settings,
+        pushPromise,
+        ping,
+        goAway,
+        windowUpdate,
+        continuation
+    };
+
+    enum class ErrorCode : unsigned int {
+        noError,
+        protocolError,
+        internalError,
+        flowControlError,
+        settingsTimeout,
+        streamClosed,
+        frameSizeError,
+        refusedStream,
+        cancel,
+        compressionError,
+        connectError,
+        enhanceYourCalm
+    };
+
+    struct Stream {
+        std::vector<Hpack::Field> fields;
+        std::string body;
+        std::vector<std::byte> data;
+        unsigned long sentSize;
+        long sendWindow, receiveWindow;
+        bool isHeaderReceived, isReceived;
+    };
+
+    static constexpr std::byte endStream{0x1}, ack{0x1}, endHeaders{0x4}, padded{0x8}, priority{0x20};
+    static constexpr unsigned int frameHeaderSize{9}, maxFrameSize{16384}, maxStreamCount{128};
+    static constexpr unsigned long maxHeaderBlockSize{64 * 1024};
+    static constexpr long defaultWindow{65535}, maxWindow{0x7fffffff};
+
+    [[nodiscard]] static auto readNumber(std::span<const std::byte> bytes) noexcept -> unsigned int;
+
+    auto handleFrame(FrameType type, std::byte flags, unsigned int streamId, std::span<const std::byte> payload,
+                     std::vector<Request> &requests) -> void;
+
+    auto handleData(std::byte flags, unsigned int streamId, std::span<const std::byte> payload,
+                    std::vector<Request> &requests) -> void;
+
+    auto handleHeaders(std::byte flags, unsigned int streamId, std::span<const std::byte> payload,
+                       std::vector<Request> &requests) -> void;
+
+    auto handleSettings(std::byte flags, unsigned int streamId, std::span<const std::byte> payload) -> void;
+
+    auto handleWindowUpdate(unsigned int streamId, std::span<const std::byte> payload) -> void;
+
+    auto finishHeaders(std::vector<Request> &requests) -> void;
+
+    auto complete(unsigned int streamId, Stream &stream, std::vector<Request> &requests) -> void;
+
+    // moves response bodies into data frames as far as the windows allow
+    auto pump() -> void;
+
+    auto writeFrame(FrameType type, std::byte flags, unsigned int streamId, std::span<const std::byte> payload)
+        -> void;
+
+    auto resetStream(unsigned int streamId, ErrorCode errorCode) -> void;
+
+    auto goAway(ErrorCode errorCode) -> void;
+
+    Hpack hpack;
+    std::map<unsigned int, Stream> streams;
+    std::vector<std::byte> input, output, headerBlock;
+    unsigned int lastStreamId{}, headerStreamId{};
+    long sendWindow{defaultWindow}, receiveWindow{defaultWindow}, initialWindow{defaultWindow};
+    bool isPrefaceReceived{}, isHeaderEndStream{}, isGoneAway{};
+};
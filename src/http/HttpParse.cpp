@@ -3,11 +3,155 @@
 #include "../fileDescriptor/Logger.hpp"
 #include "../json/JsonValue.hpp"
 #include "../log/Exception.hpp"
+#include "../metric/Tracer.hpp"
+#include "WebSocket.hpp"
 
-#include <brotli/encode.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
 #include <cmath>
-#include <filesystem>
+#include <ctime>
 #include <fstream>
+#include <iomanip>
+#include <openssl/evp.h>
+#include <optional>
+#include <sstream>
+#include <utility>
+
+// how each kind of static file is served, images and videos are compressed already
+struct Resource {
+    std::string_view extension, contentType, folder;
+    bool isCompressible;
+};
+
+constexpr std::array resources{
+    Resource{"html", "text/html; charset=utf-8", "resources/web",    true },
+    Resource{"png",  "image/jpg",                "resources/images", false},
+    Resource{"ico",  "image/x-icon",             "resources/images", true },
+    Resource{"mp4",  "video/mp4",                "resources/videos", false},
+};
+
+// below this size a dynamic body fits a packet either way, so compressing it gains nothing
+constexpr unsigned long minCompressedSize{1024};
+
+// a malformed number fails instead of throwing, and a sign is not part of a range
+[[nodiscard]] static auto parseNumber(const std::string_view value, long &number) noexcept -> bool {
+    if (value.empty() || value.front() == '-') return false;
+
+    const auto [point, error]{std::from_chars(value.data(), value.data() + value.size(), number)};
+
+    return error == std::errc{} && point == value.data() + value.size();
+}
+
+// the satisfiable ranges of a Range value in the order asked for, nothing when the value is malformed and the header
+// is ignored, each range is cut to the size of a part
+[[nodiscard]] static auto parseRanges(const std::string_view value, const long resourceSize, const long maxSize)
+    -> std::optional<std::vector<std::pair<long, long>>> {
+    // bounds the parts of a response, overlapping ranges could otherwise repeat a file many times
+    static constexpr unsigned long maxRangeCount{16};
+
+    const unsigned long splitPoint{value.find('=')};
+    if (splitPoint == std::string_view::npos) return std::nullopt;
+
+    // the unit is case insensitive and bytes is the only one
+    if (const std::string_view unit{value.substr(0, splitPoint)};
+        !std::ranges::equal(unit, std::string_view{"bytes"}, [](const char left, const char right) {
+            return std::tolower(static_cast<unsigned char>(left)) == right;
+        }))
+        return std::nullopt;
+
+    std::vector<std::pair<long, long>> ranges;
+    unsigned long rangeCount{};
+    for (unsigned long start{splitPoint + 1}; start < value.size();) {
+        const unsigned long end{std::min(value.find(',', start), value.size())};
+        std::string_view element{value.substr(start, end - start)};
+        start = end + 1;
+
+        while (!element.empty() && (element.front() == ' ' || element.front() == '\t')) element.remove_prefix(1);
+        while (!element.empty() && (element.back() == ' ' || element.back() == '\t')) element.remove_suffix(1);
+        if (element.empty()) continue;
+        if (++rangeCount > maxRangeCount) return std::nullopt;
+
+        const unsigned long dash{element.find('-')};
+        if (dash == std::string_view::npos) return std::nullopt;
+        const std::string_view firstText{element.substr(0, dash)}, lastText{element.substr(dash + 1)};
+
+        long first, last;
+        if (firstText.empty()) {
+            // a suffix counts back from the end, so it is cut at its start, and a longer one than the file means all
+            // of it
+            long length;
+            if (!parseNumber(lastText, length)) return std::nullopt;
+            if (length == 0 || resourceSize == 0) continue;
+
+            first = std::max(resourceSize - std::min(length, maxSize), 0L);
+            last = resourceSize - 1;
+        } else {
+            if (!parseNumber(firstText, first) || (!lastText.empty() && (!parseNumber(lastText, last) || last < first)))
+                return std::nullopt;
+            if (first >= resourceSize) continue;
+
+            last = lastText.empty() ? resourceSize - 1 : std::min(last, resourceSize - 1);
+        }
+
+        ranges.emplace_back(first, std::min(last, first + maxSize - 1));
+    }
+
+    if (rangeCount == 0) return std::nullopt;
+
+    return ranges;
+}
+
+// whether a comma separated header value lists the token, case insensitively and without a protocol version
+[[nodiscard]] static auto containsToken(const std::string_view value, const std::string_view token) noexcept -> bool {
+    for (unsigned long start{}; start < value.size();) {
+        const unsigned long end{std::min(value.find(',', start), value.size())};
+        std::string_view element{value.substr(start, end - start)};
+        start = end + 1;
+
+        while (!element.empty() && (element.front() == ' ' || element.front() == '\t')) element.remove_prefix(1);
+        element = element.substr(0, std::min(element.find_first_of(" \t/"), element.size()));
+
+        if (std::ranges::equal(element, token, [](const char left, const char right) {
+                return std::tolower(static_cast<unsigned char>(left)) == right;
+            }))
+            return true;
+    }
+
+    return false;
+}
+
+auto HttpParse::isExpensive(const std::string_view request) noexcept -> bool {
+    const std::string_view line{request.substr(0, request.find("\r\n"))};
+
+    // posts query the database and html pages may have to be compressed at the best level first
+    return line.starts_with("POST ") || line.substr(0, line.rfind(' ')).ends_with("html");
+}
+
+auto HttpParse::getUnavailableResponse(const bool isClosing) -> std::span<const std::byte> {
+    constexpr auto create{[](const bool isClosing) {
+        HttpResponse httpResponse;
+        httpResponse.setVersion("HTTP/1.1");
+        httpResponse.setStatusCode("503 Service Unavailable");
+        httpResponse.addHeader("Retry-After: 1");
+        if (isClosing) httpResponse.addHeader("Connection: close");
+        httpResponse.addHeader("Content-Length: 0");
+        httpResponse.setBody(std::span<const std::byte>{});
+
+        return httpResponse.toByte();
+    }};
+
+    // built once, an overloaded server shouldn't spend any work on the requests it turns away
+    static const std::array responses{create(false), create(true)};
+
+    return responses[isClosing];
+}
+
+auto HttpParse::isSwitchingProtocols(const std::span<const std::byte> response) noexcept -> bool {
+    return std::string_view{reinterpret_cast<const char *>(response.data()), response.size()}.starts_with(
+        "HTTP/1.1 101 ");
+}
 
 HttpParse::HttpParse(const std::shared_ptr<Logger> &logger) : logger{logger} {
     this->database.connect(std::string_view{}, "AomaYple", "38820233", "webServer", 0, std::string_view{}, 0);
@@ -15,6 +159,9 @@ HttpParse::HttpParse(const std::shared_ptr<Logger> &logger) : logger{logger} {
 
 auto HttpParse::parse(const std::string_view request, const std::source_location sourceLocation)
     -> std::vector<std::byte> {
+    TRACE_SCOPE("parse");
+    TRACE_PROBE(parseStart, request.size());
+
     try {
         this->httpRequest = HttpRequest{request};
         this->parseVersion();
@@ -26,7 +173,8 @@ auto HttpParse::parse(const std::string_view request, const std::source_location
         this->logger->push(Log{Log::Level::warn, exception.what(), sourceLocation});
     }
 
-    this->httpResponse.addHeader("Content-Length: " + std::to_string(this->body.size()));
+    // neither an informational nor a not modified response has content
+    if (!this->isHeaderOnly) this->httpResponse.addHeader("Content-Length: " + std::to_string(this->body.size()));
 
     if (!this->isWriteBody) this->body.clear();
     this->httpResponse.setBody(this->body);
@@ -34,15 +182,38 @@ auto HttpParse::parse(const std::string_view request, const std::source_location
     std::vector response{this->httpResponse.toByte()};
     this->clear();
 
+    TRACE_PROBE(parseEnd, response.size());
+
     return response;
 }
 
+auto HttpParse::parseMessage(const std::string_view message, const std::source_location sourceLocation)
+    -> std::vector<std::byte> {
+    std::string reply;
+    try {
+        reply = this->query(message);
+    } catch (Exception &exception) {
+        this->logger->push(std::move(exception.getLog()));
+    } catch (const std::exception &exception) {
+        this->logger->push(Log{Log::Level::warn, exception.what(), sourceLocation});
+    }
+
+    // a failed message still gets a reply, the client waits for one per message
+    if (reply.empty()) reply = "{}";
+
+    const auto bytes{std::as_bytes(std::span{reply})};
+
+    return std::vector<std::byte>{bytes.cbegin(), bytes.cend()};
+}
+
 auto HttpParse::clear() -> void {
     this->httpRequest = HttpRequest{};
     this->httpResponse = HttpResponse{};
     this->body.clear();
     this->isWriteBody = true;
-    this->isBrotli = false;
+    this->contentType = {};
+    this->isCompressible = false;
+    this->isHeaderOnly = false;
 }
 
 auto HttpParse::parseVersion() -> void {
@@ -60,33 +231,54 @@ auto HttpParse::parseMethod() -> void {
     if (const std::string_view method{this->httpRequest.getMethod()}; method == "GET" || method == "HEAD") {
         if (method == "HEAD") this->isWriteBody = false;
 
-        this->parsePath();
+        // any other upgrade, h2c among them, is ignored and the request answered as it is
+        if (method == "GET" && this->isWebSocketUpgrade()) this->parseUpgrade();
+        else this->parsePath();
     } else if (method == "POST") {
         this->httpResponse.setStatusCode("200 OK");
         this->httpResponse.addHeader("Content-Type: application/json; charset=utf-8");
 
-        const JsonObject requestBody{this->httpRequest.getBody()};
-        const std::string_view password{requestBody["password"]};
-
-        JsonObject jsonBody;
-        if (std::string_view{requestBody["method"]} == "login") {
-            jsonBody.insert("success",
-                            JsonValue{!this->database
-                                           .query(std::format("SELECT * FROM users WHERE id = {} AND password = '{}';",
-                                                              std::string_view{requestBody["id"]}, password))
-                                           .empty()});
-        } else {
-            this->database.query(std::format("INSERT INTO users (password) VALUES ('{}');", password));
-
-            jsonBody.insert("id", JsonValue{std::move(this->database.query("SELECT LAST_INSERT_ID();")[0][0])});
-        }
-
-        const auto stringBody{jsonBody.toString()};
+        const auto stringBody{this->query(this->httpRequest.getBody())};
         const auto bytes{std::as_bytes(std::span{stringBody})};
         this->body = std::vector<std::byte>{bytes.cbegin(), bytes.cend()};
+
+        // a reply is compressed anew every time, so it takes the fast level
+        if (const Compressor::Coding coding{this->negotiate()};
+            coding != Compressor::Coding::identity && this->body.size() >= minCompressedSize) {
+            this->httpResponse.addHeader("Content-Encoding: " + std::string{Compressor::getName(coding)});
+            this->body = this->compressor.compress(this->body, coding, Compressor::Level::fast);
+        }
     } else this->httpResponse.setStatusCode("405 Method Not Allowed");
 }
 
+auto HttpParse::isWebSocketUpgrade() const -> bool {
+    return this->httpRequest.containsHeader("Upgrade") && this->httpRequest.containsHeader("Connection") &&
+           containsToken(this->httpRequest.getHeaderValue("Upgrade"), "websocket") &&
+           containsToken(this->httpRequest.getHeaderValue("Connection"), "upgrade");
+}
+
+auto HttpParse::parseUpgrade() -> void {
+    if (!this->httpRequest.containsHeader("Sec-WebSocket-Key")) {
+        this->httpResponse.setStatusCode("400 Bad Request");
+
+        return;
+    }
+    if (!this->httpRequest.containsHeader("Sec-WebSocket-Version") ||
+        this->httpRequest.getHeaderValue("Sec-WebSocket-Version") != "13") {
+        this->httpResponse.setStatusCode("426 Upgrade Required");
+        this->httpResponse.addHeader("Sec-WebSocket-Version: 13");
+
+        return;
+    }
+
+    this->httpResponse.setStatusCode("101 Switching Protocols");
+    this->httpResponse.addHeader("Upgrade: websocket");
+    this->httpResponse.addHeader("Connection: Upgrade");
+    this->httpResponse.addHeader("Sec-WebSocket-Accept: " +
+                                 WebSocket::createAccept(this->httpRequest.getHeaderValue("Sec-WebSocket-Key")));
+    this->isHeaderOnly = true;
+}
+
 auto HttpParse::parsePath() -> void {
     const auto url{this->httpRequest.getUrl().substr(1)};
     if (url.empty()) {
@@ -96,24 +288,13 @@ auto HttpParse::parsePath() -> void {
     }
 
     std::string_view folder;
-    if (url.ends_with("html")) {
-        this->httpResponse.addHeader("Content-Type: text/html; charset=utf-8");
-        this->httpResponse.addHeader("Content-Encoding: br");
-        this->isBrotli = true;
-
-        folder = "resources/web";
-    } else if (url.ends_with("png")) {
-        this->httpResponse.addHeader("Content-Type: image/jpg");
-
-        folder = "resources/images";
-    } else if (url.ends_with("ico")) {
-        this->httpResponse.addHeader("Content-Type: image/x-icon");
+    if (const auto resource{std::ranges::find_if(
+            resources, [url](const Resource &element) { return url.ends_with(element.extension); })};
+        resource != resources.cend()) {
+        this->contentType = resource->contentType;
+        this->isCompressible = resource->isCompressible;
 
-        folder = "resources/images";
-    } else if (url.ends_with("mp4")) {
-        this->httpResponse.addHeader("Content-Type: video/mp4");
-
-        folder = "resources/videos";
+        folder = resource->folder;
     }
 
     std::string resourcePath;
@@ -131,85 +312,250 @@ auto HttpParse::parsePath() -> void {
 
 auto HttpParse::parseResource(const std::string &resourcePath) -> void {
     static constexpr auto maxSize{static_cast<unsigned int>(std::pow(2, 20))};
-    const auto resourceSize{static_cast<long>(std::filesystem::file_size(resourcePath))};
-    std::pair<long, long> range;
-
-    if (this->httpRequest.containsHeader("Range")) {
-        const auto rangeHeader{this->httpRequest.getHeaderValue("Range").substr(6)};
-        const unsigned long splitPoint{rangeHeader.find('-')};
-
-        const std::string stringStart{rangeHeader.cbegin(), rangeHeader.cbegin() + splitPoint};
-        range.first = std::stol(stringStart);
-
-        std::string stringEnd{rangeHeader.cbegin() + splitPoint + 1, rangeHeader.cend()};
-        if (stringEnd.empty()) {
-            range.second = range.first + maxSize - 1;
-            if (range.second > resourceSize) range.second = resourceSize - 1;
+    Validator &validator{this->getValidator(resourcePath)};
+
+    // only files small enough to be sent whole are kept compressed
+    Compressor::Coding coding{Compressor::Coding::identity};
+    if (this->isCompressible && validator.size <= maxSize) coding = this->negotiate();
+
+    // each compressed representation differs from the file, so it gets a tag of its own
+    std::string entityTag{'"' + validator.entityTag};
+    if (coding != Compressor::Coding::identity) {
+        const std::string name{Compressor::getName(coding)};
+        this->httpResponse.addHeader("Content-Encoding: " + name);
+        entityTag += '-' + name;
+    }
+    entityTag += '"';
+    this->httpResponse.addHeader("ETag: " + entityTag);
+    this->httpResponse.addHeader("Last-Modified: " + validator.lastModified);
+    this->httpResponse.addHeader("Accept-Ranges: bytes");
 
-            stringEnd = std::to_string(range.second);
-        } else range.second = std::stol(stringEnd);
+    // a revalidation is answered without reading or compressing anything
+    if (this->isNotModified(entityTag, validator)) {
+        this->httpResponse.setStatusCode("304 Not Modified");
+        this->isHeaderOnly = true;
 
-        if (range.first > range.second || range.second >= resourceSize) {
-            this->httpResponse.setStatusCode("416 Range Not Satisfiable");
-            this->httpResponse.clearHeaders();
+        return;
+    }
 
-            return;
+    const std::span representation{coding == Compressor::Coding::identity ?
+                                       std::span<const std::byte>{} :
+                                       this->getRepresentation(resourcePath, validator, coding)};
+    const auto resourceSize{
+        static_cast<long>(coding == Compressor::Coding::identity ? validator.size : representation.size())};
+
+    // only a get asks for ranges, and a changed representation is sent whole
+    std::vector<std::pair<long, long>> ranges;
+    if (this->httpRequest.getMethod() == "GET" && this->httpRequest.containsHeader("Range") &&
+        this->isRangeCurrent(entityTag, validator)) {
+        if (auto parsedRanges{parseRanges(this->httpRequest.getHeaderValue("Range"), resourceSize, maxSize)}) {
+            if (parsedRanges->empty()) {
+                this->httpResponse.setStatusCode("416 Range Not Satisfiable");
+                this->httpResponse.clearHeaders();
+                this->httpResponse.addHeader("Content-Range: bytes */" + std::to_string(resourceSize));
+
+                return;
+            }
+
+            // the parts of a compressed representation would read as one compressed multipart body
+            if (parsedRanges->size() == 1 || coding == Compressor::Coding::identity)
+                ranges = std::move(*parsedRanges);
         }
+    }
+
+    std::string boundary;
+    if (ranges.size() > 1) {
+        // the hash of the file never shows up in the file itself
+        boundary = validator.entityTag;
 
         this->httpResponse.setStatusCode("206 Partial Content");
-        this->httpResponse.addHeader("Content-Range: bytes " + stringStart + '-' + stringEnd + '/' +
-                                     std::to_string(resourceSize));
-    } else if (resourceSize > maxSize) {
-        this->httpResponse.setStatusCode("206 Partial Content");
-        this->httpResponse.addHeader("Content-Range: bytes 0-" + std::to_string(maxSize - 1) + '/' +
-                                     std::to_string(resourceSize));
+        this->httpResponse.addHeader("Content-Type: multipart/byteranges; boundary=" + boundary);
+    } else {
+        if (ranges.empty() && resourceSize > maxSize) ranges.emplace_back(0, maxSize - 1);
 
-        range = std::pair{0, maxSize - 1};
-    } else [[likely]] {
-        this->httpResponse.setStatusCode("200 OK");
+        if (ranges.empty()) [[likely]] {
+            this->httpResponse.setStatusCode("200 OK");
 
-        range = std::pair{0, resourceSize - 1};
+            ranges.emplace_back(0, resourceSize - 1);
+        } else {
+            this->httpResponse.setStatusCode("206 Partial Content");
+            this->httpResponse.addHeader(std::format("Content-Range: bytes {}-{}/{}", ranges.front().first,
+                                                     ranges.front().second, resourceSize));
+        }
+        this->httpResponse.addHeader("Content-Type: " + std::string{this->contentType});
     }
 
-    this->readResource(resourcePath, range);
+    this->readResource(resourcePath, representation, ranges, boundary, resourceSize);
 }
 
-auto HttpParse::readResource(const std::string &resourcePath, const std::pair<long, long> &range,
-                             const std::source_location sourceLocation) -> void {
+auto HttpParse::getValidator(const std::string &resourcePath, const std::source_location sourceLocation)
+    -> Validator & {
+    const std::filesystem::file_time_type modificationTime{std::filesystem::last_write_time(resourcePath)};
+    const unsigned long size{std::filesystem::file_size(resourcePath)};
+
+    Validator &validator{this->validators[resourcePath]};
+    if (!validator.entityTag.empty() && validator.modificationTime == modificationTime && validator.size == size)
+        [[likely]]
+        return validator;
+
+    const std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context{EVP_MD_CTX_new(), EVP_MD_CTX_free};
     std::ifstream file{resourcePath, std::ios::binary};
-    if (!file) {
+    if (context == nullptr || !file || EVP_DigestInit_ex(context.get(), EVP_sha256(), nullptr) != 1) {
         throw Exception{
-            Log{Log::Level::error, "cannot open file: " + resourcePath, sourceLocation}
+            Log{Log::Level::error, "cannot hash file: " + resourcePath, sourceLocation}
         };
     }
 
-    file.seekg(range.first);
+    std::array<char, 64 * 1024> buffer;
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() != 0)
+        EVP_DigestUpdate(context.get(), buffer.data(), static_cast<unsigned long>(file.gcount()));
+
+    std::array<unsigned char, EVP_MAX_MD_SIZE> digest;
+    EVP_DigestFinal_ex(context.get(), digest.data(), nullptr);
+
+    // half of the digest is plenty to tell versions of a file apart
+    validator.entityTag.clear();
+    for (const unsigned char value : std::span{digest}.first(16)) validator.entityTag += std::format("{:02x}", value);
+    validator.representations = {};
+    validator.modificationTime = modificationTime;
+    validator.lastModifiedTime =
+        std::chrono::floor<std::chrono::seconds>(std::chrono::file_clock::to_sys(modificationTime));
+    validator.lastModified = std::format("{:%a, %d %b %Y %T} GMT", validator.lastModifiedTime);
+    validator.size = size;
+
+    return validator;
+}
+
+auto HttpParse::getRepresentation(const std::string &resourcePath, Validator &validator,
+                                  const Compressor::Coding coding) -> std::span<const std::byte> {
+    std::vector<std::byte> &representation{validator.representations[std::to_underlying(coding)]};
+    if (representation.empty()) {
+        const std::array range{std::pair{0L, static_cast<long>(validator.size) - 1}};
+        this->readResource(resourcePath, {}, range, {}, static_cast<long>(validator.size));
+        representation = this->compressor.compress(this->body, coding, Compressor::Level::best);
+    }
+
+    return representation;
+}
 
-    const long size{range.second - range.first + 1};
+auto HttpParse::isRangeCurrent(const std::string_view entityTag, const Validator &validator) const -> bool {
+    if (!this->httpRequest.containsHeader("If-Range")) return true;
+
+    // a tag has to match strongly, so a weak one never does, and a date only names the version modified then
+    const std::string_view value{this->httpRequest.getHeaderValue("If-Range")};
+
+    return value.starts_with('"') ? value == entityTag : value == validator.lastModified;
+}
+
+auto HttpParse::isNotModified(const std::string_view entityTag, const Validator &validator) const -> bool {
+    if (this->httpRequest.containsHeader("If-None-Match")) {
+        const std::string_view value{this->httpRequest.getHeaderValue("If-None-Match")};
+        if (value == "*") return true;
+
+        // the weak comparison applies, so a tag matches with or without the weak prefix
+        for (unsigned long start{}; start < value.size();) {
+            const unsigned long end{std::min(value.find(',', start), value.size())};
+            std::string_view tag{value.substr(start, end - start)};
+            while (!tag.empty() && (tag.front() == ' ' || tag.front() == '\t')) tag.remove_prefix(1);
+            while (!tag.empty() && (tag.back() == ' ' || tag.back() == '\t')) tag.remove_suffix(1);
+            if (tag.starts_with("W/")) tag.remove_prefix(2);
+            if (tag == entityTag) return true;
+
+            start = end + 1;
+        }
+
+        // when both are sent the tags decide alone
+        return false;
+    }
+
+    if (this->httpRequest.containsHeader("If-Modified-Since")) {
+        std::tm time{};
+        std::istringstream stream{std::string{this->httpRequest.getHeaderValue("If-Modified-Since")}};
+        stream >> std::get_time(&time, "%a, %d %b %Y %H:%M:%S GMT");
+
+        // an unparsable date is ignored
+        if (stream.fail()) return false;
+
+        return validator.lastModifiedTime <= std::chrono::sys_seconds{std::chrono::seconds{timegm(&time)}};
+    }
+
+    return false;
+}
+
+auto HttpParse::readResource(const std::string &resourcePath, const std::span<const std::byte> representation,
+                             const std::span<const std::pair<long, long>> ranges, const std::string_view boundary,
+                             const long resourceSize, const std::source_location sourceLocation) -> void {
+    std::vector<std::string> partHeaders;
+    std::string trailer;
+    unsigned long size{};
+    for (const auto &[first, last] : ranges) {
+        if (ranges.size() > 1) {
+            const std::string &partHeader{partHeaders.emplace_back(
+                std::format("\r\n--{}\r\nContent-Type: {}\r\nContent-Range: bytes {}-{}/{}\r\n\r\n", boundary,
+                            this->contentType, first, last, resourceSize))};
+            size += partHeader.size();
+        }
+        size += last - first + 1;
+    }
+    if (ranges.size() > 1) trailer = std::format("\r\n--{}--\r\n", boundary);
+    size += trailer.size();
+
+    std::ifstream file;
+    if (representation.empty()) {
+        file.open(resourcePath, std::ios::binary);
+        if (!file) {
+            throw Exception{
+                Log{Log::Level::error, "cannot open file: " + resourcePath, sourceLocation}
+            };
+        }
+    }
+
+    // sized once, then every range is read or copied straight to where it belongs
     this->body.resize(size);
-    if (!file.read(reinterpret_cast<char *>(this->body.data()), size)) {
-        throw Exception{
-            Log{Log::Level::error, "cannot read file: " + resourcePath, sourceLocation}
-        };
+    std::byte *position{this->body.data()};
+    for (unsigned long i{}; i != ranges.size(); ++i) {
+        if (!partHeaders.empty())
+            position = std::ranges::copy(std::as_bytes(std::span{partHeaders[i]}), position).out;
+
+        const auto [first, last]{ranges[i]};
+        const long rangeSize{last - first + 1};
+        if (!representation.empty()) std::ranges::copy(representation.subspan(first, rangeSize), position);
+        else if (!file.seekg(first) || !file.read(reinterpret_cast<char *>(position), rangeSize)) {
+            throw Exception{
+                Log{Log::Level::error, "cannot read file: " + resourcePath, sourceLocation}
+            };
+        }
+        position += rangeSize;
     }
+    std::ranges::copy(std::as_bytes(std::span{trailer}), position);
+}
+
+auto HttpParse::negotiate() -> Compressor::Coding {
+    this->httpResponse.addHeader("Vary: Accept-Encoding");
 
-    if (this->isBrotli) this->brotli();
+    return Compressor::negotiate(this->httpRequest.containsHeader("Accept-Encoding") ?
+                                     this->httpRequest.getHeaderValue("Accept-Encoding") :
+                                     std::string_view{});
 }
 
-auto HttpParse::brotli(const std::source_location sourceLocation) -> void {
-    unsigned long encodedSize{BrotliEncoderMaxCompressedSize(this->body.size())};
-    std::vector<std::byte> encodedBody{encodedSize};
+auto HttpParse::query(const std::string_view request) -> std::string {
+    const JsonObject requestBody{request};
+    const std::string_view password{requestBody["password"]};
+
+    JsonObject jsonBody;
+    if (std::string_view{requestBody["method"]} == "login") {
+        jsonBody.insert("success",
+                        JsonValue{!this->database
+                                       .query(std::format("SELECT * FROM users WHERE id = {} AND password = '{}';",
+                                                          std::string_view{requestBody["id"]}, password))
+                                       .empty()});
+    } else {
+        this->database.query(std::format("INSERT INTO users (password) VALUES ('{}');", password));
 
-    if (BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_MAX_WINDOW_BITS, BROTLI_DEFAULT_MODE, this->body.size(),
-                              reinterpret_cast<const unsigned char *>(this->body.data()), &encodedSize,
-                              reinterpret_cast<unsigned char *>(encodedBody.data())) != BROTLI_TRUE) {
-        throw Exception{
-            Log{Log::Level::error, "brotli compress failed", sourceLocation}
-        };
+        jsonBody.insert("id", JsonValue{std::move(this->database.query("SELECT LAST_INSERT_ID();")[0][0])});
     }
 
-    encodedBody.resize(encodedSize);
-    this->body = std::move(encodedBody);
+    return jsonBody.toString();
 }
 
 auto HttpParse::handleException() -> void {
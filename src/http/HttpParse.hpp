@@ -1,13 +1,24 @@
 #pragma once
 
+#include "Compressor.hpp"
 #include "Database.hpp"
 #include "HttpRequest.hpp"
 #include "HttpResponse.hpp"
 
+#include <chrono>
+#include <filesystem>
+
 class Logger;
 
 class HttpParse {
 public:
+    [[nodiscard]] static auto isExpensive(std::string_view request) noexcept -> bool;
+
+    [[nodiscard]] static auto getUnavailableResponse(bool isClosing) -> std::span<const std::byte>;
+
+    // after this response the connection speaks websocket
+    [[nodiscard]] static auto isSwitchingProtocols(std::span<const std::byte> response) noexcept -> bool;
+
     explicit HttpParse(const std::shared_ptr<Logger> &logger);
 
     HttpParse(const HttpParse &) = delete;
@@ -24,28 +35,69 @@ public:
                              std::source_location sourceLocation = std::source_location::current())
         -> std::vector<std::byte>;
 
+    // a websocket message carries the same json as the body of a post, so does the reply
+    [[nodiscard]] auto parseMessage(std::string_view message,
+                                    std::source_location sourceLocation = std::source_location::current())
+        -> std::vector<std::byte>;
+
 private:
+    // the validators of one version of a file, the version changes with its modification time or size
+    struct Validator {
+        std::filesystem::file_time_type modificationTime;
+        std::chrono::sys_seconds lastModifiedTime;
+        unsigned long size;
+        std::string entityTag, lastModified;
+        // compressed at the best level the first time a coding is asked for
+        std::array<std::vector<std::byte>, 3> representations;
+    };
+
     auto clear() -> void;
 
     auto parseVersion() -> void;
 
     auto parseMethod() -> void;
 
+    // a websocket among the offered upgrades of a get whose Connection names the upgrade, anything else is ignored
+    [[nodiscard]] auto isWebSocketUpgrade() const -> bool;
+
+    auto parseUpgrade() -> void;
+
     auto parsePath() -> void;
 
     auto parseResource(const std::string &resourcePath) -> void;
 
-    auto readResource(const std::string &resourcePath, const std::pair<long, long> &range,
+    [[nodiscard]] auto getValidator(const std::string &resourcePath,
+                                    std::source_location sourceLocation = std::source_location::current())
+        -> Validator &;
+
+    [[nodiscard]] auto getRepresentation(const std::string &resourcePath, Validator &validator,
+                                         Compressor::Coding coding) -> std::span<const std::byte>;
+
+    [[nodiscard]] auto isNotModified(std::string_view entityTag, const Validator &validator) const -> bool;
+
+    // whether If-Range, when sent, still names the current representation
+    [[nodiscard]] auto isRangeCurrent(std::string_view entityTag, const Validator &validator) const -> bool;
+
+    // fills the body with the ranges of the file, or of the representation when there is one, several ranges become
+    // the parts of a multipart/byteranges body
+    auto readResource(const std::string &resourcePath, std::span<const std::byte> representation,
+                      std::span<const std::pair<long, long>> ranges, std::string_view boundary, long resourceSize,
                       std::source_location sourceLocation = std::source_location::current()) -> void;
 
-    auto brotli(std::source_location sourceLocation = std::source_location::current()) -> void;
+    // picks the coding a compressible body may be sent with, the response then varies on Accept-Encoding
+    [[nodiscard]] auto negotiate() -> Compressor::Coding;
+
+    [[nodiscard]] auto query(std::string_view request) -> std::string;
 
     auto handleException() -> void;
 
     HttpRequest httpRequest;
     HttpResponse httpResponse;
     Database database;
+    Compressor compressor;
+    std::unordered_map<std::string, Validator> validators;
     std::vector<std::byte> body;
-    bool isWriteBody{true}, isBrotli{};
+    std::string_view contentType;
+    bool isWriteBody{true}, isCompressible{}, isHeaderOnly{};
     std::shared_ptr<Logger> logger;
 };
@@ -0,0 +1,179 @@
+#include "WebSocket.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <openssl/evp.h>
+#include <utility>
+
+auto WebSocket::createAccept(const std::string_view key) -> std::string {
+    const std::string text{std::string{key} + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"};
+
+    std::array<unsigned char, EVP_MAX_MD_SIZE> digest;
+    unsigned int digestSize{};
+    EVP_Digest(text.data(), text.size(), digest.data(), &digestSize, EVP_sha1(), nullptr);
+
+    // base64 of the 20 byte digest is 28 characters and a terminator
+    std::array<unsigned char, 29> accept;
+    const int acceptSize{EVP_EncodeBlock(accept.data(), digest.data(), static_cast<int>(digestSize))};
+
+    return std::string{reinterpret_cast<const char *>(accept.data()), static_cast<unsigned long>(acceptSize)};
+}
+
+auto WebSocket::receive(const std::span<const std::byte> data) -> std::vector<std::string> {
+    std::vector<std::string> messages;
+    if (this->isCloseQueued) return messages;
+
+    this->input.insert(this->input.cend(), data.cbegin(), data.cend());
+
+    unsigned long offset{};
+    while (!this->isCloseQueued) {
+        const std::span frame{std::span{this->input}.subspan(offset)};
+        if (frame.size() < 2) break;
+
+        const auto first{std::to_integer<unsigned char>(frame[0])}, second{std::to_integer<unsigned char>(frame[1])};
+        unsigned long headerSize{2}, size{second & 0x7fU};
+        if (size == 126) {
+            headerSize = 4;
+            if (frame.size() < headerSize) break;
+
+            size = std::to_integer<unsigned long>(frame[2]) << 8 | std::to_integer<unsigned long>(frame[3]);
+        } else if (size == 127) {
+            headerSize = 10;
+            if (frame.size() < headerSize) break;
+
+            size = 0;
+            for (unsigned int i{2}; i != headerSize; ++i) size = size << 8 | std::to_integer<unsigned long>(frame[i]);
+        }
+
+        // frames of a client are always masked and no extension was negotiated that could use the reserved bits
+        if ((second & 0x80U) == 0 || (first & 0x70U) != 0) {
+            this->close(CloseCode::protocolError);
+
+            break;
+        }
+        if (size > maxMessageSize) {
+            this->close(CloseCode::messageTooBig);
+
+            break;
+        }
+
+        if (frame.size() < headerSize + 4 + size) break;
+
+        const std::span payload{frame.subspan(headerSize + 4, size)};
+        unmask(payload, frame.subspan(headerSize).first<4>());
+        offset += headerSize + 4 + size;
+
+        this->handleFrame((first & 0x80U) != 0, static_cast<Opcode>(first & 0x0fU), payload, messages);
+    }
+
+    if (this->isCloseQueued) this->input.clear();
+    else this->input.erase(this->input.cbegin(), this->input.cbegin() + static_cast<long>(offset));
+
+    return messages;
+}
+
+auto WebSocket::send(const std::span<const std::byte> message) -> void { this->writeFrame(Opcode::text, message); }
+
+auto WebSocket::close(const CloseCode closeCode) -> void {
+    const auto code{std::to_underlying(closeCode)};
+    const std::array payload{static_cast<std::byte>(code >> 8), static_cast<std::byte>(code)};
+    this->writeFrame(Opcode::close, payload);
+
+    this->isCloseQueued = true;
+}
+
+auto WebSocket::hasOutput() const noexcept -> bool { return !this->output.empty(); }
+
+auto WebSocket::takeOutput() noexcept -> std::vector<std::byte> { return std::move(this->output); }
+
+auto WebSocket::isClosed() const noexcept -> bool { return this->isCloseQueued; }
+
+auto WebSocket::unmask(const std::span<std::byte> payload, const std::span<const std::byte, 4> key) noexcept -> void {
+    // 16 bytes at a time, the vector extension becomes sse2 or neon instructions without any target flag, and as the
+    // block is a multiple of the key, the key lines up again at every block
+    using Block = unsigned char __attribute__((vector_size(16)));
+
+    Block keyBlock;
+    for (unsigned int i{}; i != sizeof(Block); ++i) keyBlock[i] = std::to_integer<unsigned char>(key[i % key.size()]);
+
+    unsigned long i{};
+    for (; i + sizeof(Block) <= payload.size(); i += sizeof(Block)) {
+        Block block;
+        std::memcpy(&block, payload.data() + i, sizeof(block));
+        block ^= keyBlock;
+        std::memcpy(payload.data() + i, &block, sizeof(block));
+    }
+    for (; i != payload.size(); ++i) payload[i] ^= key[i % key.size()];
+}
+
+auto WebSocket::handleFrame(const bool isFinal, const Opcode opcode, const std::span<const std::byte> payload,
+                            std::vector<std::string> &messages) -> void {
+    switch (opcode) {
+        case Opcode::continuation:
+            if (!this->isFragmented) {
+                this->close(CloseCode::protocolError);
+
+                return;
+            }
+
+            break;
+        case Opcode::text:
+        case Opcode::binary:
+            if (this->isFragmented) {
+                this->close(CloseCode::protocolError);
+
+                return;
+            }
+            this->isFragmented = true;
+
+            break;
+        case Opcode::close:
+        case Opcode::ping:
+        case Opcode::pong:
+            if (!isFinal || payload.size() > maxControlSize) this->close(CloseCode::protocolError);
+            else if (opcode == Opcode::ping) this->writeFrame(Opcode::pong, payload);
+            else if (opcode == Opcode::close) {
+                // the status code of the peer is echoed back, which completes the closing handshake
+                this->writeFrame(Opcode::close, payload.first(std::min(payload.size(), 2UL)));
+                this->isCloseQueued = true;
+            }
+
+            return;
+        default:
+            this->close(CloseCode::protocolError);
+
+            return;
+    }
+
+    if (this->message.size() + payload.size() > maxMessageSize) {
+        this->close(CloseCode::messageTooBig);
+
+        return;
+    }
+    this->message.append(reinterpret_cast<const char *>(payload.data()), payload.size());
+
+    if (isFinal) {
+        messages.emplace_back(std::move(this->message));
+        this->message.clear();
+        this->isFragmented = false;
+    }
+}
+
+auto WebSocket::writeFrame(const Opcode opcode, const std::span<const std::byte> payload) -> void {
+    this->output.emplace_back(static_cast<std::byte>(0x80U | std::to_underlying(opcode)));
+
+    // frames of a server are never masked
+    if (payload.size() < 126) this->output.emplace_back(static_cast<std::byte>(payload.size()));
+    else if (payload.size() <= 0xffff) {
+        this->output.emplace_back(std::byte{126});
+        for (int shift{8}; shift >= 0; shift -= 8)
+            this->output.emplace_back(static_cast<std::byte>(payload.size() >> shift));
+    } else {
+        this->output.emplace_back(std::byte{127});
+        for (int shift{56}; shift >= 0; shift -= 8)
+            this->output.emplace_back(static_cast<std::byte>(payload.size() >> shift));
+    }
+
+    this->output.insert(this->output.cend(), payload.cbegin(), payload.cend());
+}
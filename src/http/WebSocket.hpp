@@ -0,0 +1,50 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+// the server side of an rfc 6455 connection after the upgrade, frames are parsed as they arrive and replies are queued
+// as frames, so those queued while a send is in flight go out together in the next one
+class WebSocket {
+public:
+    enum class CloseCode : unsigned short {
+        normal = 1000,
+        protocolError = 1002,
+        messageTooBig = 1009,
+        tryAgainLater = 1013
+    };
+
+    // the value of Sec-WebSocket-Accept for the key of a handshake
+    [[nodiscard]] static auto createAccept(std::string_view key) -> std::string;
+
+    // consumes received bytes and returns the messages they completed
+    [[nodiscard]] auto receive(std::span<const std::byte> data) -> std::vector<std::string>;
+
+    auto send(std::span<const std::byte> message) -> void;
+
+    auto close(CloseCode closeCode) -> void;
+
+    [[nodiscard]] auto hasOutput() const noexcept -> bool;
+
+    [[nodiscard]] auto takeOutput() noexcept -> std::vector<std::byte>;
+
+    // set once a close frame was queued, nothing more is read
+    [[nodiscard]] auto isClosed() const noexcept -> bool;
+
+private:
+    enum class Opcode : unsigned char { continuation, text, binary, close = 8, ping, pong };
+
+    static constexpr unsigned long maxMessageSize{1024 * 1024}, maxControlSize{125};
+
+    static auto unmask(std::span<std::byte> payload, std::span<const std::byte, 4> key) noexcept -> void;
+
+    auto handleFrame(bool isFinal, Opcode opcode, std::span<const std::byte> payload,
+                     std::vector<std::string> &messages) -> void;
+
+    auto writeFrame(Opcode opcode, std::span<const std::byte> payload) -> void;
+
+    std::vector<std::byte> input, output;
+    std::string message;
+    bool isFragmented{}, isCloseQueued{};
+};
@@ -1,17 +1,36 @@
 #include "coroutine/Scheduler.hpp"
 
-auto main() -> int {
+auto main(const int argc, const char *const *const argv) -> int {
+    const Configuration configuration{Configuration::parse(std::span{argv + 1, static_cast<unsigned long>(argc - 1)})};
+
     Scheduler::registerSignal();
 
-    std::atomic_uint cpuCode;
-    Scheduler scheduler{-1, cpuCode};
+    // the listeners are created here, in cpu order, so that their positions in the reuseport group match the cpus,
+    // a unix socket is a single listener that every scheduler accepts from
+    std::vector<std::vector<int>> serverFileDescriptors(std::jthread::hardware_concurrency());
+    for (const std::string &address : configuration.listenAddresses) {
+        if (Server::isUnixAddress(address)) {
+            const int fileDescriptor{Server::create(address)};
+            for (std::vector<int> &fileDescriptors : serverFileDescriptors)
+                fileDescriptors.emplace_back(fileDescriptor);
+        } else {
+            for (std::vector<int> &fileDescriptors : serverFileDescriptors)
+                fileDescriptors.emplace_back(Server::create(address));
+        }
+    }
+
+    const std::shared_ptr workerPool{std::make_shared<WorkerPool>(configuration.workerCount)};
+
+    Scheduler scheduler{configuration, -1, 0, serverFileDescriptors.front(), workerPool};
 
-    std::vector<std::jthread> workers{std::jthread::hardware_concurrency() - 1};
-    for (const int sharedFileDescriptor{scheduler.getRingFileDescriptor()}; auto &worker : workers) {
-        worker = std::jthread{[sharedFileDescriptor, &cpuCode] {
-            Scheduler otherScheduler{sharedFileDescriptor, cpuCode++};
+    std::vector<std::jthread> workers;
+    for (unsigned int cpuCode{1}; cpuCode != serverFileDescriptors.size(); ++cpuCode) {
+        workers.emplace_back([&configuration, sharedFileDescriptor{scheduler.getRingFileDescriptor()}, cpuCode,
+                              &serverFileDescriptors, &workerPool] {
+            Scheduler otherScheduler{configuration, sharedFileDescriptor, cpuCode, serverFileDescriptors[cpuCode],
+                                     workerPool};
             otherScheduler.run();
-        }};
+        });
     }
 
     scheduler.run();
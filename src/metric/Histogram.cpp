@@ -0,0 +1,69 @@
+#include "Histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+Histogram::Histogram() : Histogram{64} {}
+
+Histogram::Histogram(const unsigned int valueBits) :
+    counts((valueBits - subBucketBits + 2) * halfSubBucketCount),
+    highest{valueBits == 64 ? std::numeric_limits<unsigned long>::max() : (1UL << valueBits) - 1} {}
+
+auto Histogram::record(unsigned long value) noexcept -> void {
+    value = std::min(value, this->highest);
+
+    ++this->counts[getIndex(value)];
+    ++this->count;
+    this->max = std::max(this->max, value);
+    this->sum += value;
+}
+
+auto Histogram::merge(const Histogram &other) noexcept -> void {
+    std::ranges::transform(this->counts, other.counts, this->counts.begin(), std::plus{});
+    this->count += other.count;
+    this->max = std::max(this->max, other.max);
+    this->sum += other.sum;
+}
+
+auto Histogram::clear() noexcept -> void {
+    std::ranges::fill(this->counts, 0);
+    this->count = 0;
+    this->max = 0;
+    this->sum = 0;
+}
+
+auto Histogram::getCount() const noexcept -> unsigned long { return this->count; }
+
+auto Histogram::getMax() const noexcept -> unsigned long { return this->max; }
+
+auto Histogram::getMean() const noexcept -> double {
+    return this->count == 0 ? 0 : static_cast<double>(this->sum) / static_cast<double>(this->count);
+}
+
+auto Histogram::getPercentile(const double percentile) const noexcept -> unsigned long {
+    const unsigned long rank{
+        std::max(static_cast<unsigned long>(percentile / 100 * static_cast<double>(this->count) + 0.5), 1UL)};
+
+    unsigned long seen{};
+    for (unsigned long i{}; i != this->counts.size(); ++i) {
+        seen += this->counts[i];
+        if (seen >= rank) return std::min(getHighestValue(i), this->max);
+    }
+
+    return this->max;
+}
+
+auto Histogram::getIndex(const unsigned long value) noexcept -> unsigned long {
+    const unsigned long shift{
+        std::max(static_cast<unsigned int>(std::bit_width(value)), subBucketBits) - subBucketBits};
+
+    return shift * halfSubBucketCount + (value >> shift);
+}
+
+auto Histogram::getHighestValue(const unsigned long index) noexcept -> unsigned long {
+    const unsigned long shift{index < 2 * halfSubBucketCount ? 0 : index / halfSubBucketCount - 1},
+        subBucket{index - shift * halfSubBucketCount};
+
+    return ((subBucket + 1) << shift) - 1;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+class Histogram {
+public:
+    Histogram();
+
+    // values above the range of valueBits are recorded as its highest value
+    explicit Histogram(unsigned int valueBits);
+
+    auto record(unsigned long value) noexcept -> void;
+
+    auto merge(const Histogram &other) noexcept -> void;
+
+    auto clear() noexcept -> void;
+
+    [[nodiscard]] auto getCount() const noexcept -> unsigned long;
+
+    [[nodiscard]] auto getMax() const noexcept -> unsigned long;
+
+    [[nodiscard]] auto getMean() const noexcept -> double;
+
+    [[nodiscard]] auto getPercentile(double percentile) const noexcept -> unsigned long;
+
+private:
+    // every power of two range is split into 64 linear buckets, so a recorded value is off by less than 1/64
+    static constexpr unsigned int subBucketBits{7};
+    static constexpr unsigned long halfSubBucketCount{1UL << (subBucketBits - 1)};
+
+    [[nodiscard]] static auto getIndex(unsigned long value) noexcept -> unsigned long;
+
+    [[nodiscard]] static auto getHighestValue(unsigned long index) noexcept -> unsigned long;
+
+    std::vector<unsigned long> counts;
+    unsigned long highest, count{}, max{}, sum{};
+};
@@ -0,0 +1,91 @@
+#include "LatencyTable.hpp"
+
+#include <format>
+#include <iterator>
+#include <utility>
+
+auto LatencyTable::getRoute(const std::string_view request) noexcept -> Route {
+    const std::string_view line{request.substr(0, request.find("\r\n"))};
+
+    if (line.starts_with("POST ")) {
+        const unsigned long headerEnd{request.find("\r\n\r\n")};
+
+        return headerEnd != std::string_view::npos && request.find("login", headerEnd) != std::string_view::npos ?
+                   Route::login :
+                   Route::registration;
+    }
+
+    const std::string_view url{line.substr(0, line.rfind(' '))};
+    if (url.ends_with("html")) return Route::html;
+    if (url.ends_with("png") || url.ends_with("ico")) return Route::image;
+    if (url.ends_with("mp4")) return Route::video;
+
+    return Route::other;
+}
+
+LatencyTable::LatencyTable() : histograms(routeNames.size() * statusNames.size(), Histogram{valueBits}) {}
+
+auto LatencyTable::record(const Route route, const std::span<const std::byte> response,
+                          const std::chrono::steady_clock::duration latency) noexcept -> void {
+    // the status code follows "HTTP/1.1 ", anything unexpected counts as a server error
+    unsigned long status{statusNames.size() - 1};
+    if (response.size() > 9) {
+        if (const auto digit{static_cast<unsigned char>(response[9])}; digit >= '1' && digit <= '5')
+            status = digit - '1';
+    }
+
+    this->histograms[std::to_underlying(route) * statusNames.size() + status].record(
+        std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+}
+
+auto LatencyTable::merge(const LatencyTable &other) noexcept -> void {
+    for (unsigned long i{}; i != this->histograms.size(); ++i) this->histograms[i].merge(other.histograms[i]);
+}
+
+auto LatencyTable::format() const -> std::string {
+    constexpr std::string_view name{"webserver_route_latency_seconds"};
+    constexpr std::array quantiles{0.5, 0.9, 0.99, 0.999};
+
+    std::string text{std::format("# HELP {} Time from the first request byte to the completed send, by route and "
+                                 "status class.\n# TYPE {} summary\n",
+                                 name, name)};
+    for (unsigned long route{}; route != routeNames.size(); ++route) {
+        for (unsigned long status{}; status != statusNames.size(); ++status) {
+            const Histogram &histogram{this->getHistogram(route, status)};
+            if (histogram.getCount() == 0) continue;
+
+            const std::string labels{std::format(R"(route="{}",status="{}")", routeNames[route], statusNames[status])};
+            for (const double quantile : quantiles) {
+                std::format_to(std::back_inserter(text), "{}{{{},quantile=\"{}\"}} {}\n", name, labels, quantile,
+                               static_cast<double>(histogram.getPercentile(quantile * 100)) / 1e6);
+            }
+            std::format_to(std::back_inserter(text), "{}_sum{{{}}} {}\n{}_count{{{}}} {}\n", name, labels,
+                           histogram.getMean() * static_cast<double>(histogram.getCount()) / 1e6, name, labels,
+                           histogram.getCount());
+        }
+    }
+
+    return text;
+}
+
+auto LatencyTable::toStrings() const -> std::vector<std::string> {
+    std::vector<std::string> strings;
+    for (unsigned long route{}; route != routeNames.size(); ++route) {
+        for (unsigned long status{}; status != statusNames.size(); ++status) {
+            const Histogram &histogram{this->getHistogram(route, status)};
+            if (histogram.getCount() == 0) continue;
+
+            strings.emplace_back(std::format("latency {} {}: count {}, p50 {}us, p99 {}us, p99.9 {}us, max {}us",
+                                             routeNames[route], statusNames[status], histogram.getCount(),
+                                             histogram.getPercentile(50), histogram.getPercentile(99),
+                                             histogram.getPercentile(99.9), histogram.getMax()));
+        }
+    }
+
+    return strings;
+}
+
+auto LatencyTable::getHistogram(const unsigned long route, const unsigned long status) const noexcept
+    -> const Histogram & {
+    return this->histograms[route * statusNames.size() + status];
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Histogram.hpp"
+
+#include <array>
+#include <chrono>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class LatencyTable {
+public:
+    enum class Route : unsigned char { html, image, video, login, registration, other };
+
+    [[nodiscard]] static auto getRoute(std::string_view request) noexcept -> Route;
+
+    LatencyTable();
+
+    auto record(Route route, std::span<const std::byte> response, std::chrono::steady_clock::duration latency) noexcept
+        -> void;
+
+    auto merge(const LatencyTable &other) noexcept -> void;
+
+    // a prometheus summary of every route and status class that saw a response
+    [[nodiscard]] auto format() const -> std::string;
+
+    // one line per route and status class that saw a response
+    [[nodiscard]] auto toStrings() const -> std::vector<std::string>;
+
+private:
+    static constexpr std::array<std::string_view, 6> routeNames{"html", "image", "video", "login", "register", "other"};
+    static constexpr std::array<std::string_view, 5> statusNames{"1xx", "2xx", "3xx", "4xx", "5xx"};
+
+    // microseconds up to 32 bits cover more than an hour in less than half the memory of a full range
+    static constexpr unsigned int valueBits{32};
+
+    [[nodiscard]] auto getHistogram(unsigned long route, unsigned long status) const noexcept -> const Histogram &;
+
+    std::vector<Histogram> histograms;
+};
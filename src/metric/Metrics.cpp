@@ -0,0 +1,123 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+
+auto Metrics::format(const std::span<const Metrics> metrics) -> std::string {
+    std::string text;
+
+    const auto formatFamily{[&text, metrics](const std::string_view name, const std::string_view type,
+                                             const std::string_view help, auto &&getValue) {
+        std::format_to(std::back_inserter(text), "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+        for (unsigned long i{}; i != metrics.size(); ++i)
+            std::format_to(std::back_inserter(text), "{}{{cpu=\"{}\"}} {}\n", name, i, getValue(metrics[i]));
+    }};
+    const auto load{[](const std::atomic_ulong &value) { return value.load(std::memory_order::relaxed); }};
+
+    formatFamily("webserver_requests_total", "counter", "Requests received.",
+                 [load](const Metrics &element) { return load(element.requestCount); });
+    formatFamily("webserver_shed_requests_total", "counter", "Requests answered with 503 by load shedding.",
+                 [load](const Metrics &element) { return load(element.shedRequestCount); });
+    formatFamily("webserver_frames_total", "counter", "Event loop frames.",
+                 [load](const Metrics &element) { return load(element.frameCount); });
+    formatFamily("webserver_completions_total", "counter", "Completion queue entries reaped.",
+                 [load](const Metrics &element) { return load(element.completionCount); });
+    formatFamily("webserver_buffer_starvations_total", "counter", "Receives that found the buffer ring empty.",
+                 [load](const Metrics &element) { return load(element.bufferStarvationCount); });
+    formatFamily("webserver_connections", "gauge", "Open connections.",
+                 [load](const Metrics &element) { return load(element.connectionCount); });
+    formatFamily("webserver_tasks", "gauge", "Coroutines in flight.",
+                 [load](const Metrics &element) { return load(element.taskCount); });
+    formatFamily("webserver_log_backlog", "gauge", "Logs waiting to be written.",
+                 [load](const Metrics &element) { return load(element.logBacklog); });
+    formatFamily("webserver_napi_busy_poll", "gauge", "Whether napi busy polling is registered on the ring.",
+                 [](const Metrics &element) { return element.isNapi.load(std::memory_order::relaxed) ? 1 : 0; });
+
+    const auto formatHistogram{[&text, metrics, load](const std::string_view name, const std::string_view help,
+                                                      const auto &bounds, auto &&getCounts, auto &&getSum) {
+        std::format_to(std::back_inserter(text), "# HELP {} {}\n# TYPE {} histogram\n", name, help, name);
+        for (unsigned long i{}; i != metrics.size(); ++i) {
+            unsigned long count{};
+            for (unsigned long j{}; j != getCounts(metrics[i]).size(); ++j) {
+                count += load(getCounts(metrics[i])[j]);
+
+                if (j != bounds.size()) {
+                    std::format_to(std::back_inserter(text), "{}_bucket{{cpu=\"{}\",le=\"{}\"}} {}\n", name, i,
+                                   std::chrono::duration<double>{bounds[j]}.count(), count);
+                } else {
+                    std::format_to(std::back_inserter(text), "{}_bucket{{cpu=\"{}\",le=\"+Inf\"}} {}\n", name, i,
+                                   count);
+                }
+            }
+
+            std::format_to(std::back_inserter(text), "{}_sum{{cpu=\"{}\"}} {}\n{}_count{{cpu=\"{}\"}} {}\n", name, i,
+                           std::chrono::duration<double>{std::chrono::nanoseconds{load(getSum(metrics[i]))}}.count(),
+                           name, i, count);
+        }
+    }};
+
+    formatHistogram(
+        "webserver_request_duration_seconds", "Time from a complete request to its sent response.", latencyBounds,
+        [](const Metrics &element) -> const auto & { return element.latencyCounts; },
+        [](const Metrics &element) -> const auto & { return element.latencySum; });
+    formatHistogram(
+        "webserver_wait_duration_seconds",
+        "Time a frame blocked in io_uring_enter until a completion, spent busy polling instead of asleep with napi.",
+        waitBounds, [](const Metrics &element) -> const auto & { return element.waitCounts; },
+        [](const Metrics &element) -> const auto & { return element.waitSum; });
+
+    text += mergeLatencies(metrics).format();
+
+    return text;
+}
+
+auto Metrics::mergeLatencies(const std::span<const Metrics> metrics) -> LatencyTable {
+    LatencyTable latencies;
+    for (const Metrics &element : metrics) {
+        const std::lock_guard lockGuard{element.lock};
+        latencies.merge(element.latencies);
+    }
+
+    return latencies;
+}
+
+auto Metrics::addRequest() noexcept -> void { increase(this->requestCount); }
+
+auto Metrics::addShedRequest() noexcept -> void { increase(this->shedRequestCount); }
+
+auto Metrics::addResponse(const std::chrono::steady_clock::duration latency) noexcept -> void {
+    increase(this->latencyCounts[std::ranges::lower_bound(latencyBounds, latency) - latencyBounds.cbegin()]);
+    increase(this->latencySum, std::chrono::nanoseconds{latency}.count());
+}
+
+auto Metrics::addFrame(const unsigned long completionCount) noexcept -> void {
+    increase(this->frameCount);
+    increase(this->completionCount, completionCount);
+}
+
+auto Metrics::addWait(const std::chrono::steady_clock::duration duration) noexcept -> void {
+    increase(this->waitCounts[std::ranges::lower_bound(waitBounds, duration) - waitBounds.cbegin()]);
+    increase(this->waitSum, std::chrono::nanoseconds{duration}.count());
+}
+
+auto Metrics::addBufferStarvation() noexcept -> void { increase(this->bufferStarvationCount); }
+
+auto Metrics::setGauges(const unsigned long connectionCount, const unsigned long taskCount,
+                        const unsigned long logBacklog) noexcept -> void {
+    this->connectionCount.store(connectionCount, std::memory_order::relaxed);
+    this->taskCount.store(taskCount, std::memory_order::relaxed);
+    this->logBacklog.store(logBacklog, std::memory_order::relaxed);
+}
+
+auto Metrics::setNapi(const bool isNapi) noexcept -> void { this->isNapi.store(isNapi, std::memory_order::relaxed); }
+
+auto Metrics::publishLatencies(const LatencyTable &latencies) -> void {
+    const std::lock_guard lockGuard{this->lock};
+    this->latencies = latencies;
+}
+
+auto Metrics::increase(std::atomic_ulong &counter, const unsigned long value) noexcept -> void {
+    // only the owning scheduler writes, a relaxed load and store keeps readers tear free without a locked instruction
+    counter.store(counter.load(std::memory_order::relaxed) + value, std::memory_order::relaxed);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "LatencyTable.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <span>
+#include <string>
+
+class Metrics {
+public:
+    [[nodiscard]] static auto format(std::span<const Metrics> metrics) -> std::string;
+
+    [[nodiscard]] static auto mergeLatencies(std::span<const Metrics> metrics) -> LatencyTable;
+
+    auto addRequest() noexcept -> void;
+
+    auto addShedRequest() noexcept -> void;
+
+    auto addResponse(std::chrono::steady_clock::duration latency) noexcept -> void;
+
+    auto addFrame(unsigned long completionCount) noexcept -> void;
+
+    // time spent in io_uring_enter until a completion was posted, napi busy polling shifts it towards the low buckets
+    auto addWait(std::chrono::steady_clock::duration duration) noexcept -> void;
+
+    auto addBufferStarvation() noexcept -> void;
+
+    auto setGauges(unsigned long connectionCount, unsigned long taskCount, unsigned long logBacklog) noexcept -> void;
+
+    auto setNapi(bool isNapi) noexcept -> void;
+
+    // the owning scheduler records into its own table and only hands over a copy now and then
+    auto publishLatencies(const LatencyTable &latencies) -> void;
+
+private:
+    static constexpr std::array<std::chrono::microseconds, 14> latencyBounds{
+        std::chrono::microseconds{50},     std::chrono::microseconds{100},    std::chrono::microseconds{250},
+        std::chrono::microseconds{500},    std::chrono::milliseconds{1},      std::chrono::microseconds{2500},
+        std::chrono::milliseconds{5},      std::chrono::milliseconds{10},     std::chrono::milliseconds{25},
+        std::chrono::milliseconds{50},     std::chrono::milliseconds{100},    std::chrono::milliseconds{250},
+        std::chrono::milliseconds{500},    std::chrono::seconds{1},
+    };
+
+    static constexpr std::array<std::chrono::microseconds, 12> waitBounds{
+        std::chrono::microseconds{1},   std::chrono::microseconds{5},   std::chrono::microseconds{10},
+        std::chrono::microseconds{25},  std::chrono::microseconds{50},  std::chrono::microseconds{100},
+        std::chrono::microseconds{250}, std::chrono::microseconds{500}, std::chrono::milliseconds{1},
+        std::chrono::milliseconds{10},  std::chrono::milliseconds{100}, std::chrono::seconds{1},
+    };
+
+    static auto increase(std::atomic_ulong &counter, unsigned long value = 1) noexcept -> void;
+
+    std::atomic_ulong requestCount, shedRequestCount, frameCount, completionCount, bufferStarvationCount,
+        connectionCount, taskCount, logBacklog, latencySum, waitSum;
+    std::array<std::atomic_ulong, latencyBounds.size() + 1> latencyCounts;
+    std::array<std::atomic_ulong, waitBounds.size() + 1> waitCounts;
+    std::atomic_bool isNapi;
+    mutable std::mutex lock;
+    LatencyTable latencies;
+};
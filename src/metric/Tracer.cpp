@@ -0,0 +1,69 @@
+#include "Tracer.hpp"
+
+#ifdef WEBSERVER_TRACING
+
+#include "../log/Exception.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+Tracer::Scope::Scope(const char *const name) noexcept : name{name}, start{std::chrono::steady_clock::now()} {}
+
+Tracer::Scope::~Scope() {
+    record(Event{this->name, this->start, std::chrono::steady_clock::now()});
+}
+
+auto Tracer::requestDump() noexcept -> void { generation.fetch_add(1, std::memory_order::relaxed); }
+
+auto Tracer::isDumpRequested() noexcept -> bool {
+    return buffer.generation != generation.load(std::memory_order::relaxed);
+}
+
+auto Tracer::dump(const unsigned int cpuCode, const std::source_location sourceLocation) -> std::string {
+    buffer.generation = generation.load(std::memory_order::relaxed);
+
+    // events are recorded when they end, the oldest frame still in the buffer marks where complete frames begin
+    const unsigned long count{std::min(buffer.count, capacity)};
+    std::chrono::steady_clock::time_point begin{std::chrono::steady_clock::time_point::max()};
+    for (unsigned long i{buffer.count - count}; i != buffer.count; ++i) {
+        if (const Event &event{buffer.events[i % capacity]}; std::string_view{event.name} == "frame") {
+            begin = event.start;
+
+            break;
+        }
+    }
+
+    std::string text{R"({"traceEvents":[)"};
+    const int processId{getpid()};
+    for (unsigned long i{buffer.count - count}; i != buffer.count; ++i) {
+        const Event &event{buffer.events[i % capacity]};
+        if (event.start < begin) continue;
+
+        const std::chrono::duration<double, std::micro> timestamp{event.start.time_since_epoch()},
+            duration{event.end - event.start};
+        std::format_to(std::back_inserter(text),
+                       R"({}{{"name":"{}","cat":"webServer","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":{},"tid":{}}})",
+                       text.back() == '[' ? "" : ",", event.name, timestamp.count(), duration.count(), processId,
+                       cpuCode);
+    }
+    text += "]}";
+
+    std::string fileName{std::format("trace.{}.json", cpuCode)};
+    if (std::ofstream file{fileName, std::ios::binary | std::ios::trunc}; !file.write(text.data(), text.size())) {
+        throw Exception{
+            Log{Log::Level::error, "failed to write " + fileName, sourceLocation}
+        };
+    }
+
+    return fileName;
+}
+
+auto Tracer::record(const Event &event) noexcept -> void { buffer.events[buffer.count++ % capacity] = event; }
+
+constinit std::atomic_uint Tracer::generation;
+thread_local Tracer::Buffer Tracer::buffer{std::vector<Event>(capacity), 0, 0};
+
+#endif
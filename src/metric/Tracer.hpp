@@ -0,0 +1,80 @@
+#pragma once
+
+// everything below only exists when WEBSERVER_TRACING is defined, release builds leave every macro empty
+#ifdef WEBSERVER_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <source_location>
+#include <string>
+#include <vector>
+
+// static tracepoints are nops until a tool like bpftrace or perf attaches to usdt:webServer:<name>
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define TRACE_PROBE(name, ...) STAP_PROBEV(webServer, name __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define TRACE_PROBE(name, ...)
+#endif
+
+#define TRACE_JOIN(prefix, line) prefix##line
+#define TRACE_NAME(prefix, line) TRACE_JOIN(prefix, line)
+#define TRACE_SCOPE(name) const Tracer::Scope TRACE_NAME(traceScope, __LINE__){name}
+
+class Tracer {
+    struct Event {
+        const char *name;
+        std::chrono::steady_clock::time_point start, end;
+    };
+
+    struct Buffer {
+        std::vector<Event> events;
+        unsigned long count;
+        unsigned int generation;
+    };
+
+public:
+    // records the time from its construction to its destruction as one event of the calling thread
+    class Scope {
+    public:
+        explicit Scope(const char *name) noexcept;
+
+        Scope(const Scope &) = delete;
+
+        Scope(Scope &&) = delete;
+
+        auto operator=(const Scope &) -> Scope & = delete;
+
+        auto operator=(Scope &&) -> Scope & = delete;
+
+        ~Scope();
+
+    private:
+        const char *name;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // async signal safe, every scheduler thread notices the request after its current frame
+    static auto requestDump() noexcept -> void;
+
+    [[nodiscard]] static auto isDumpRequested() noexcept -> bool;
+
+    // writes the events of the calling thread as chrome trace event json and returns the file name
+    static auto dump(unsigned int cpuCode, std::source_location sourceLocation = std::source_location::current())
+        -> std::string;
+
+private:
+    static constexpr unsigned long capacity{64 * 1024};
+
+    static auto record(const Event &event) noexcept -> void;
+
+    static constinit std::atomic_uint generation;
+    static thread_local Buffer buffer;
+};
+
+#else
+
+#define TRACE_PROBE(name, ...)
+#define TRACE_SCOPE(name)
+
+#endif
@@ -1,9 +1,11 @@
 #include "Ring.hpp"
 
 #include "../log/Exception.hpp"
-#include "Completion.hpp"
+#include "../metric/Tracer.hpp"
 #include "Submission.hpp"
 
+#include <algorithm>
+
 Ring::Ring(const unsigned int entries, io_uring_params &params) :
     handle{[entries, &params](const std::source_location sourceLocation = std::source_location::current()) {
         io_uring handle{};
@@ -17,7 +19,9 @@ Ring::Ring(const unsigned int entries, io_uring_params &params) :
         return handle;
     }()} {}
 
-Ring::Ring(Ring &&other) noexcept : handle{other.handle} { other.handle.ring_fd = -1; }
+Ring::Ring(Ring &&other) noexcept : handle{other.handle}, overflows{std::move(other.overflows)} {
+    other.handle.ring_fd = -1;
+}
 
 auto Ring::operator=(Ring &&other) noexcept -> Ring & {
     if (this == &other) return *this;
@@ -26,6 +30,7 @@ auto Ring::operator=(Ring &&other) noexcept -> Ring & {
 
     this->handle = other.handle;
     other.handle.ring_fd = -1;
+    this->overflows = std::move(other.overflows);
 
     return *this;
 }
@@ -55,6 +60,20 @@ auto Ring::registerCpu(const unsigned int cpuCode, const std::source_location so
     }
 }
 
+auto Ring::registerNapi(const unsigned int busyPollTimeout, const bool isPreferBusyPoll,
+                       const std::source_location sourceLocation) -> void {
+    io_uring_napi napi{};
+    napi.busy_poll_to = busyPollTimeout;
+    napi.prefer_busy_poll = isPreferBusyPoll;
+
+    if (const int result{io_uring_register_napi(&this->handle, &napi)}; result != 0) {
+        throw Exception{
+            Log{Log::Level::error, std::error_code{std::abs(result), std::generic_category()}.message(),
+                sourceLocation}
+        };
+    }
+}
+
 auto Ring::registerSparseFileDescriptor(const unsigned int count, const std::source_location sourceLocation) -> void {
     if (const int result{io_uring_register_files_sparse(&this->handle, count)}; result != 0) {
         throw Exception{
@@ -110,9 +129,55 @@ auto Ring::freeRingBuffer(io_uring_buf_ring *const ringBufferHandle, const unsig
     }
 }
 
-auto Ring::submit(const Submission &submission) -> void {
-    io_uring_sqe *const sqe{this->getSqe()};
+auto Ring::submit(const Submission &submission, const std::source_location sourceLocation) -> void {
+    TRACE_PROBE(submit, submission.parameter.index(), submission.fileDescriptor, submission.userData);
+
+    // requests queued behind a full queue keep their order
+    if (!this->overflows.empty()) [[unlikely]] {
+        this->overflows.emplace_back(submission);
+
+        return;
+    }
+
+    io_uring_sqe *sqe{io_uring_get_sqe(&this->handle)};
+    if (sqe == nullptr) [[unlikely]] {
+        // a full queue is handed to the kernel right away, whatever still doesn't fit waits for the next wait
+        this->flush(sourceLocation);
+
+        sqe = io_uring_get_sqe(&this->handle);
+        if (sqe == nullptr) {
+            this->overflows.emplace_back(submission);
+
+            return;
+        }
+    }
+
+    prepare(sqe, submission);
+}
+
+auto Ring::isCongested() const noexcept -> bool { return !this->overflows.empty(); }
+
+auto Ring::wait(const unsigned int count, const std::source_location sourceLocation) -> void {
+    TRACE_SCOPE("wait");
+
+    while (this->drain() && !this->overflows.empty()) this->flush(sourceLocation);
+
+    // with a kernel poller, completions that are already posted can be reaped without entering the kernel
+    const bool isPolled{(this->handle.flags & IORING_SETUP_SQPOLL) != 0 && io_uring_cq_ready(&this->handle) >= count};
+
+    // a full completion queue refuses submissions, the caller reaps it and the requests go in with the next wait
+    if (const int result{isPolled ? io_uring_submit(&this->handle) : io_uring_submit_and_wait(&this->handle, count)};
+        result < 0 && result != -EBUSY && result != -EAGAIN) {
+        throw Exception{
+            Log{Log::Level::error, std::error_code{std::abs(result), std::generic_category()}.message(),
+                sourceLocation}
+        };
+    }
+
+    TRACE_PROBE(waitReturn, count, io_uring_cq_ready(&this->handle));
+}
 
+auto Ring::prepare(io_uring_sqe *const sqe, const Submission &submission) noexcept -> void {
     switch (static_cast<Submission::Type>(submission.parameter.index())) {
         case Submission::Type::write:
             {
@@ -145,9 +210,13 @@ auto Ring::submit(const Submission &submission) -> void {
             }
         [[likely]] case Submission::Type::send:
             {
-                const auto [buffer, flags, zeroCopyFlags]{std::get<Submission::Send>(submission.parameter)};
-                io_uring_prep_send_zc(sqe, submission.fileDescriptor, buffer.data(), buffer.size(), flags,
-                                      zeroCopyFlags);
+                // sockets without zero copy support, such as unix ones, would fail the request
+                const auto [buffer, flags, zeroCopyFlags, isCopied]{std::get<Submission::Send>(submission.parameter)};
+                if (isCopied) io_uring_prep_send(sqe, submission.fileDescriptor, buffer.data(), buffer.size(), flags);
+                else {
+                    io_uring_prep_send_zc(sqe, submission.fileDescriptor, buffer.data(), buffer.size(), flags,
+                                          zeroCopyFlags);
+                }
 
                 break;
             }
@@ -160,36 +229,38 @@ auto Ring::submit(const Submission &submission) -> void {
             io_uring_prep_close_direct(sqe, submission.fileDescriptor);
 
             break;
-    }
+        case Submission::Type::message:
+            {
+                const auto [fileDescriptor, userData]{std::get<Submission::Message>(submission.parameter)};
+                io_uring_prep_msg_ring_fd_alloc(sqe, submission.fileDescriptor, fileDescriptor, userData, 0);
 
-    io_uring_sqe_set_flags(sqe, submission.flags);
-    sqe->ioprio |= submission.ioPriority;
-    io_uring_sqe_set_data64(sqe, submission.userData);
-}
+                break;
+            }
+        case Submission::Type::nop:
+            io_uring_prep_nop(sqe);
 
-auto Ring::wait(const unsigned int count, const std::source_location sourceLocation) -> void {
-    if (const int result{io_uring_submit_and_wait(&this->handle, count)}; result < 0) {
-        throw Exception{
-            Log{Log::Level::error, std::error_code{std::abs(result), std::generic_category()}.message(),
-                sourceLocation}
-        };
-    }
-}
+            break;
+        case Submission::Type::timeout:
+            {
+                const auto [time, flags]{std::get<Submission::Timeout>(submission.parameter)};
+                io_uring_prep_timeout(sqe, time, 0, flags);
 
-auto Ring::poll(std::move_only_function<auto(const Completion &completion)->void> &&action) const -> int {
-    int count{};
+                break;
+            }
+        case Submission::Type::socketOption:
+            {
+                // the option is set through the ring, a direct descriptor has no file descriptor to call setsockopt on
+                const auto [level, name, value]{std::get<Submission::SocketOption>(submission.parameter)};
+                io_uring_prep_cmd_sock(sqe, SOCKET_URING_OP_SETSOCKOPT, submission.fileDescriptor, level, name,
+                                       const_cast<std::byte *>(value.data()), static_cast<int>(value.size()));
 
-    unsigned int head;
-    const io_uring_cqe *cqe;
-    io_uring_for_each_cqe(&this->handle, head, cqe) {
-        action(Completion{
-            Outcome{cqe->res, cqe->flags},
-            io_uring_cqe_get_data64(cqe)
-        });
-        ++count;
+                break;
+            }
     }
 
-    return count;
+    io_uring_sqe_set_flags(sqe, submission.flags);
+    sqe->ioprio |= submission.ioPriority;
+    io_uring_sqe_set_data64(sqe, submission.userData);
 }
 
 auto Ring::advance(io_uring_buf_ring *const ringBuffer, const int completionCount, const int ringBufferCount) noexcept
@@ -197,17 +268,32 @@ auto Ring::advance(io_uring_buf_ring *const ringBuffer, const int completionCoun
     __io_uring_buf_ring_cq_advance(&this->handle, ringBuffer, completionCount, ringBufferCount);
 }
 
+auto Ring::advance(const int completionCount) noexcept -> void { io_uring_cq_advance(&this->handle, completionCount); }
+
 auto Ring::destroy() noexcept -> void {
     if (this->handle.ring_fd != -1) io_uring_queue_exit(&this->handle);
 }
 
-auto Ring::getSqe(const std::source_location sourceLocation) -> io_uring_sqe * {
-    io_uring_sqe *const sqe{io_uring_get_sqe(&this->handle)};
-    if (sqe == nullptr) {
+auto Ring::drain() noexcept -> bool {
+    const auto end{std::ranges::find_if(this->overflows, [this](const Submission &submission) {
+        io_uring_sqe *const sqe{io_uring_get_sqe(&this->handle)};
+        if (sqe != nullptr) prepare(sqe, submission);
+
+        return sqe == nullptr;
+    })};
+
+    const bool isDrained{end != this->overflows.cbegin()};
+    this->overflows.erase(this->overflows.cbegin(), end);
+
+    return isDrained;
+}
+
+auto Ring::flush(const std::source_location sourceLocation) -> void {
+    // a busy completion queue is backpressure rather than a failure, the requests stay queued until it is reaped
+    if (const int result{io_uring_submit(&this->handle)}; result < 0 && result != -EBUSY && result != -EAGAIN) {
         throw Exception{
-            Log{Log::Level::error, "no sqe available", sourceLocation}
+            Log{Log::Level::error, std::error_code{std::abs(result), std::generic_category()}.message(),
+                sourceLocation}
         };
     }
-
-    return sqe;
 }
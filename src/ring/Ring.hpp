@@ -1,11 +1,13 @@
 #pragma once
 
-#include <functional>
+#include "Completion.hpp"
+
+#include <array>
 #include <liburing.h>
 #include <source_location>
 #include <span>
+#include <vector>
 
-struct Completion;
 struct Submission;
 
 class Ring {
@@ -29,6 +31,9 @@ public:
     auto registerCpu(unsigned int cpuCode, std::source_location sourceLocation = std::source_location::current())
         -> void;
 
+    auto registerNapi(unsigned int busyPollTimeout, bool isPreferBusyPoll,
+                      std::source_location sourceLocation = std::source_location::current()) -> void;
+
     auto registerSparseFileDescriptor(unsigned int count,
                                       std::source_location sourceLocation = std::source_location::current()) -> void;
 
@@ -45,18 +50,44 @@ public:
     auto freeRingBuffer(io_uring_buf_ring *ringBufferHandle, unsigned int entries, int id,
                         std::source_location sourceLocation = std::source_location::current()) -> void;
 
-    auto submit(const Submission &submission) -> void;
+    auto submit(const Submission &submission, std::source_location sourceLocation = std::source_location::current())
+        -> void;
+
+    [[nodiscard]] auto isCongested() const noexcept -> bool;
 
     auto wait(unsigned int count, std::source_location sourceLocation = std::source_location::current()) -> void;
 
-    [[nodiscard]] auto poll(std::move_only_function<auto(const Completion &completion)->void> &&action) const -> int;
+    template<typename Action>
+    [[nodiscard]] auto poll(Action &&action) -> int {
+        std::array<io_uring_cqe *, 256> cqes;
+        const unsigned int count{io_uring_peek_batch_cqe(&this->handle, cqes.data(), cqes.size())};
+
+        for (unsigned int i{}; i != count; ++i) {
+            // the user data of the next completion is the coroutine frame it resumes
+            if (i + 1 != count) __builtin_prefetch(reinterpret_cast<const void *>(cqes[i + 1]->user_data));
+
+            action(Completion{
+                Outcome{cqes[i]->res, cqes[i]->flags},
+                cqes[i]->user_data
+            });
+        }
+
+        return static_cast<int>(count);
+    }
 
     auto advance(io_uring_buf_ring *ringBuffer, int completionCount, int ringBufferCount) noexcept -> void;
 
+    auto advance(int completionCount) noexcept -> void;
+
 private:
     auto destroy() noexcept -> void;
 
-    [[nodiscard]] auto getSqe(std::source_location sourceLocation = std::source_location::current()) -> io_uring_sqe *;
+    static auto prepare(io_uring_sqe *sqe, const Submission &submission) noexcept -> void;
+
+    [[nodiscard]] auto drain() noexcept -> bool;
+
+    auto flush(std::source_location sourceLocation = std::source_location::current()) -> void;
 
     io_uring handle;
+    std::vector<Submission> overflows;
 };
@@ -1,11 +1,24 @@
 #pragma once
 
+#include <linux/time_types.h>
 #include <span>
 #include <sys/socket.h>
 #include <variant>
 
 struct Submission {
-    enum class Type : unsigned char { write, accept, read, receive, send, cancel, close };
+    enum class Type : unsigned char {
+        write,
+        accept,
+        read,
+        receive,
+        send,
+        cancel,
+        close,
+        message,
+        nop,
+        timeout,
+        socketOption
+    };
 
     struct Write {
         std::span<const std::byte> buffer;
@@ -33,6 +46,7 @@ struct Submission {
         std::span<const std::byte> buffer;
         int flags;
         unsigned int zeroCopyFlags;
+        bool isCopied;
     };
 
     struct Cancel {
@@ -41,9 +55,26 @@ struct Submission {
 
     struct Close {};
 
+    struct Message {
+        int fileDescriptor;
+        unsigned long userData;
+    };
+
+    struct Nop {};
+
+    struct Timeout {
+        __kernel_timespec *time;
+        unsigned int flags;
+    };
+
+    struct SocketOption {
+        int level, name;
+        std::span<const std::byte> value;
+    };
+
     int fileDescriptor;
     unsigned int flags;
     unsigned short ioPriority;
     unsigned long userData;
-    std::variant<Write, Accept, Read, Receive, Send, Cancel, Close> parameter;
+    std::variant<Write, Accept, Read, Receive, Send, Cancel, Close, Message, Nop, Timeout, SocketOption> parameter;
 };
@@ -0,0 +1,41 @@
+#include "TlsContext.hpp"
+
+#include "../log/Exception.hpp"
+#include "TlsHandshake.hpp"
+
+#include <openssl/err.h>
+
+auto TlsContext::Deleter::operator()(SSL_CTX *const handle) const noexcept -> void { SSL_CTX_free(handle); }
+
+auto TlsContext::getError() -> std::string {
+    std::string error;
+    for (unsigned long code{ERR_get_error()}; code != 0; code = ERR_get_error()) {
+        std::array<char, 256> buffer;
+        ERR_error_string_n(code, buffer.data(), buffer.size());
+
+        if (!error.empty()) error += "; ";
+        error += buffer.data();
+    }
+
+    return error.empty() ? "tls failed" : error;
+}
+
+TlsContext::TlsContext(const std::string &certificatePath, const std::string &privateKeyPath,
+                       const std::source_location sourceLocation) :
+    handle{SSL_CTX_new(TLS_server_method())} {
+    // a session ticket would be the first record encrypted with the traffic secrets, before the kernel takes them
+    // over at sequence number 0
+    if (this->handle == nullptr || SSL_CTX_set_min_proto_version(this->handle.get(), TLS1_3_VERSION) != 1 ||
+        SSL_CTX_set_num_tickets(this->handle.get(), 0) != 1 ||
+        SSL_CTX_use_certificate_chain_file(this->handle.get(), certificatePath.c_str()) != 1 ||
+        SSL_CTX_use_PrivateKey_file(this->handle.get(), privateKeyPath.c_str(), SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(this->handle.get()) != 1) {
+        throw Exception{
+            Log{Log::Level::fatal, getError(), sourceLocation}
+        };
+    }
+
+    SSL_CTX_set_keylog_callback(this->handle.get(), TlsHandshake::logSecret);
+}
+
+auto TlsContext::get() const noexcept -> SSL_CTX * { return this->handle.get(); }
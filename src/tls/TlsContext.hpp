@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <openssl/ssl.h>
+#include <source_location>
+#include <string>
+
+// what every handshake of the server starts from, only tls 1.3 is offered, its traffic secrets are what the kernel
+// takes over once a handshake finished
+class TlsContext {
+    struct Deleter {
+        auto operator()(SSL_CTX *handle) const noexcept -> void;
+    };
+
+public:
+    // the reasons queued by the last failed call of the library
+    [[nodiscard]] static auto getError() -> std::string;
+
+    TlsContext(const std::string &certificatePath, const std::string &privateKeyPath,
+               std::source_location sourceLocation = std::source_location::current());
+
+    TlsContext(const TlsContext &) = delete;
+
+    constexpr TlsContext(TlsContext &&) noexcept = default;
+
+    auto operator=(const TlsContext &) -> TlsContext & = delete;
+
+    constexpr auto operator=(TlsContext &&) noexcept -> TlsContext & = default;
+
+    constexpr ~TlsContext() = default;
+
+    [[nodiscard]] auto get() const noexcept -> SSL_CTX *;
+
+private:
+    std::unique_ptr<SSL_CTX, Deleter> handle;
+};
@@ -0,0 +1,189 @@
+#include "TlsHandshake.hpp"
+
+#include "../log/Exception.hpp"
+#include "TlsContext.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <endian.h>
+#include <linux/tls.h>
+#include <openssl/core_names.h>
+#include <openssl/kdf.h>
+
+// hkdf-expand-label of rfc 8446 with an empty context
+[[nodiscard]] static auto expandLabel(const std::span<const std::byte> secret, const std::string_view label,
+                                      const unsigned long size, const char *const digest,
+                                      const std::source_location sourceLocation) -> std::vector<std::byte> {
+    std::vector info{static_cast<unsigned char>(size >> 8), static_cast<unsigned char>(size),
+                     static_cast<unsigned char>(6 + label.size())};
+    for (const char character : "tls13 " + std::string{label}) info.emplace_back(character);
+    info.emplace_back(0);
+
+    const std::unique_ptr<EVP_KDF, decltype(&EVP_KDF_free)> function{EVP_KDF_fetch(nullptr, "HKDF", nullptr),
+                                                                     EVP_KDF_free};
+    const std::unique_ptr<EVP_KDF_CTX, decltype(&EVP_KDF_CTX_free)> context{
+        function == nullptr ? nullptr : EVP_KDF_CTX_new(function.get()), EVP_KDF_CTX_free};
+
+    int mode{EVP_KDF_HKDF_MODE_EXPAND_ONLY};
+    const std::array parameters{
+        OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST, const_cast<char *>(digest), 0),
+        OSSL_PARAM_construct_int(OSSL_KDF_PARAM_MODE, &mode),
+        OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY, const_cast<std::byte *>(secret.data()), secret.size()),
+        OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_INFO, info.data(), info.size()), OSSL_PARAM_construct_end()};
+
+    std::vector<std::byte> key(size);
+    if (context == nullptr || EVP_KDF_derive(context.get(), reinterpret_cast<unsigned char *>(key.data()), key.size(),
+                                             parameters.data()) != 1) {
+        throw Exception{
+            Log{Log::Level::error, TlsContext::getError(), sourceLocation}
+        };
+    }
+
+    return key;
+}
+
+template<typename T>
+[[nodiscard]] auto createCryptoInfo(const unsigned short cipher, const std::span<const std::byte> secret,
+                                    const char *const digest, const unsigned long sequence,
+                                    const std::source_location sourceLocation) -> std::vector<std::byte> {
+    T cryptoInfo{};
+    cryptoInfo.info.version = TLS_1_3_VERSION;
+    cryptoInfo.info.cipher_type = cipher;
+
+    // tls 1.3 derives a single nonce, the kernel takes its head as salt and the rest as what tls 1.2 calls the iv
+    const std::vector key{expandLabel(secret, "key", sizeof(cryptoInfo.key), digest, sourceLocation)},
+        iv{expandLabel(secret, "iv", sizeof(cryptoInfo.salt) + sizeof(cryptoInfo.iv), digest, sourceLocation)};
+    std::memcpy(cryptoInfo.key, key.data(), key.size());
+    std::memcpy(cryptoInfo.salt, iv.data(), sizeof(cryptoInfo.salt));
+    std::memcpy(cryptoInfo.iv, iv.data() + sizeof(cryptoInfo.salt), sizeof(cryptoInfo.iv));
+
+    const unsigned long recordSequence{htobe64(sequence)};
+    std::memcpy(cryptoInfo.rec_seq, &recordSequence, sizeof(cryptoInfo.rec_seq));
+
+    std::vector<std::byte> result(sizeof(cryptoInfo));
+    std::memcpy(result.data(), &cryptoInfo, sizeof(cryptoInfo));
+
+    return result;
+}
+
+auto TlsHandshake::Deleter::operator()(SSL *const handle) const noexcept -> void { SSL_free(handle); }
+
+auto TlsHandshake::logSecret(const SSL *const ssl, const char *const line) -> void {
+    const std::string_view text{line};
+
+    auto &handshake{*static_cast<TlsHandshake *>(SSL_get_app_data(ssl))};
+    std::vector<std::byte> *secret;
+    if (text.starts_with("CLIENT_TRAFFIC_SECRET_0 ")) secret = &handshake.clientSecret;
+    else if (text.starts_with("SERVER_TRAFFIC_SECRET_0 ")) secret = &handshake.serverSecret;
+    else return;
+
+    // a label, the client random and the secret, the last two in hex
+    const std::string_view hex{text.substr(text.rfind(' ') + 1)};
+    secret->clear();
+    for (unsigned long i{}; i + 1 < hex.size(); i += 2) {
+        unsigned char value{};
+        std::from_chars(hex.data() + i, hex.data() + i + 2, value, 16);
+        secret->emplace_back(static_cast<std::byte>(value));
+    }
+}
+
+TlsHandshake::TlsHandshake(const TlsContext &context, const std::source_location sourceLocation) :
+    handle{SSL_new(context.get())} {
+    if (this->handle != nullptr) {
+        this->input = BIO_new(BIO_s_mem());
+        this->output = BIO_new(BIO_s_mem());
+    }
+    if (this->input == nullptr || this->output == nullptr) {
+        BIO_free(this->input);
+        BIO_free(this->output);
+
+        throw Exception{
+            Log{Log::Level::error, TlsContext::getError(), sourceLocation}
+        };
+    }
+
+    SSL_set_bio(this->handle.get(), this->input, this->output);
+    SSL_set_accept_state(this->handle.get());
+    SSL_set_app_data(this->handle.get(), this);
+}
+
+auto TlsHandshake::advance(const std::span<const std::byte> data, const std::source_location sourceLocation) -> bool {
+    if (BIO_write(this->input, data.data(), static_cast<int>(data.size())) != static_cast<int>(data.size())) {
+        throw Exception{
+            Log{Log::Level::error, TlsContext::getError(), sourceLocation}
+        };
+    }
+
+    if (!this->isFinished) {
+        if (const int result{SSL_do_handshake(this->handle.get())}; result == 1) this->isFinished = true;
+        else if (const int error{SSL_get_error(this->handle.get(), result)};
+                 error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE) {
+            throw Exception{
+                Log{Log::Level::warn, TlsContext::getError(), sourceLocation}
+            };
+        }
+    }
+
+    // the kernel can only pick up the stream at the start of a record
+    return this->isFinished && this->countRecords() != -1;
+}
+
+auto TlsHandshake::takeOutput() -> std::vector<std::byte> {
+    std::vector<std::byte> data(BIO_ctrl_pending(this->output));
+    if (!data.empty()) BIO_read(this->output, data.data(), static_cast<int>(data.size()));
+
+    return data;
+}
+
+auto TlsHandshake::takeData(const std::source_location sourceLocation) -> std::vector<std::byte> {
+    this->receivedRecordCount = static_cast<unsigned long>(this->countRecords());
+
+    std::vector<std::byte> data;
+    std::array<std::byte, 16 * 1024> buffer;
+    while (BIO_ctrl_pending(this->input) != 0) {
+        if (const int result{SSL_read(this->handle.get(), buffer.data(), buffer.size())}; result > 0)
+            data.insert(data.cend(), buffer.cbegin(), buffer.cbegin() + result);
+        else if (SSL_get_error(this->handle.get(), result) != SSL_ERROR_WANT_READ) {
+            throw Exception{
+                Log{Log::Level::warn, TlsContext::getError(), sourceLocation}
+            };
+        }
+    }
+
+    return data;
+}
+
+auto TlsHandshake::getCryptoInfo(const bool isTransmit, const std::source_location sourceLocation) const
+    -> std::vector<std::byte> {
+    // no session ticket went out, so the server starts at 0, the client at the records decrypted here
+    const std::span<const std::byte> secret{isTransmit ? this->serverSecret : this->clientSecret};
+    const unsigned long sequence{isTransmit ? 0 : this->receivedRecordCount};
+
+    switch (SSL_CIPHER_get_id(SSL_get_current_cipher(this->handle.get()))) {
+        case TLS1_3_CK_AES_128_GCM_SHA256:
+            return createCryptoInfo<tls12_crypto_info_aes_gcm_128>(TLS_CIPHER_AES_GCM_128, secret, "SHA256", sequence,
+                                                                   sourceLocation);
+        case TLS1_3_CK_AES_256_GCM_SHA384:
+            return createCryptoInfo<tls12_crypto_info_aes_gcm_256>(TLS_CIPHER_AES_GCM_256, secret, "SHA384", sequence,
+                                                                   sourceLocation);
+        case TLS1_3_CK_CHACHA20_POLY1305_SHA256:
+            return createCryptoInfo<tls12_crypto_info_chacha20_poly1305>(TLS_CIPHER_CHACHA20_POLY1305, secret,
+                                                                         "SHA256", sequence, sourceLocation);
+        default:
+            throw Exception{
+                Log{Log::Level::warn, "cipher suite not supported by kernel tls", sourceLocation}
+            };
+    }
+}
+
+auto TlsHandshake::countRecords() const noexcept -> long {
+    unsigned char *data;
+    const long size{BIO_get_mem_data(this->input, &data)};
+
+    long count{}, offset{};
+    // a record header is the content type, the version and the big endian length
+    for (; offset + 5 <= size; ++count)
+        offset += 5 + (data[offset + 3] << 8 | data[offset + 4]);
+
+    return offset == size ? count : -1;
+}
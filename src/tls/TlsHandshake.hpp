@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <openssl/ssl.h>
+#include <source_location>
+#include <span>
+#include <vector>
+
+class TlsContext;
+
+// the server side of one handshake run over memory bios, the ring moves its bytes and the kernel takes over the
+// record layer once it finished
+class TlsHandshake {
+    struct Deleter {
+        auto operator()(SSL *handle) const noexcept -> void;
+    };
+
+public:
+    // collects the traffic secrets, the library reports them in the format of SSLKEYLOGFILE
+    static auto logSecret(const SSL *ssl, const char *line) -> void;
+
+    explicit TlsHandshake(const TlsContext &context,
+                          std::source_location sourceLocation = std::source_location::current());
+
+    TlsHandshake(const TlsHandshake &) = delete;
+
+    // the library keeps a pointer back to it
+    TlsHandshake(TlsHandshake &&) noexcept = delete;
+
+    auto operator=(const TlsHandshake &) -> TlsHandshake & = delete;
+
+    auto operator=(TlsHandshake &&) noexcept -> TlsHandshake & = delete;
+
+    ~TlsHandshake() = default;
+
+    // feeds received bytes, true once the handshake finished and the bytes behind it end on a record boundary
+    [[nodiscard]] auto advance(std::span<const std::byte> data,
+                               std::source_location sourceLocation = std::source_location::current()) -> bool;
+
+    [[nodiscard]] auto takeOutput() -> std::vector<std::byte>;
+
+    // decrypts what the peer sent right behind its finished, it was read before the kernel could take it
+    [[nodiscard]] auto takeData(std::source_location sourceLocation = std::source_location::current())
+        -> std::vector<std::byte>;
+
+    // the crypto info to set as TLS_TX or TLS_RX
+    [[nodiscard]] auto getCryptoInfo(bool isTransmit,
+                                     std::source_location sourceLocation = std::source_location::current()) const
+        -> std::vector<std::byte>;
+
+private:
+    // the number of whole records waiting in the input, or -1 if the last one is cut short
+    [[nodiscard]] auto countRecords() const noexcept -> long;
+
+    std::unique_ptr<SSL, Deleter> handle;
+    BIO *input{}, *output{};
+    std::vector<std::byte> clientSecret, serverSecret;
+    unsigned long receivedRecordCount{};
+    bool isFinished{};
+};